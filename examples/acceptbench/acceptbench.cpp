@@ -0,0 +1,131 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+/// Connections per second of TcpServer, accepting one connection per
+/// poll (batch 1, the old behavior) against draining the backlog in
+/// batches.
+///
+/// Client threads connect to the loopback in a tight loop, the server
+/// closes every connection as soon as it is established, the client
+/// waits for the FIN and closes, so TIME_WAIT stays on the server side
+/// and doesn't eat up ephemeral ports of the clients.
+
+#include "libel/base/Thread.h"
+#include "libel/base/logging.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/sockets_ops.h"
+#include "libel/net/tcp_server.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+static std::atomic<bool> g_running(false);
+
+static void onConnection(const TcpConnectionPtr& conn) {
+  if (conn->connected()) {
+    conn->forceClose();
+  }
+}
+
+static void connectLoop(const InetAddress& serverAddr) {
+  char buf[16];
+  while (g_running.load(std::memory_order_relaxed)) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (sockfd < 0) {
+      LOG_FATAL << "socket";
+    }
+    if (sockets::connect(sockfd, serverAddr.getSockAddr()) == 0) {
+      while (::read(sockfd, buf, sizeof buf) > 0) {
+      }
+    }
+    ::close(sockfd);
+  }
+}
+
+struct Result {
+  double seconds;
+  Acceptor::Stats stats;
+};
+
+static void drive(EventLoop* loop, TcpServer* server,
+                  const InetAddress& serverAddr, int numClients,
+                  double seconds, Result* result) {
+  g_running = true;
+  std::vector<std::unique_ptr<Thread>> clients;
+  for (int i = 0; i < numClients; ++i) {
+    clients.emplace_back(
+        new Thread(std::bind(connectLoop, serverAddr), nullptr, "client"));
+    clients.back()->start();
+  }
+  /// warm up
+  ::usleep(200 * 1000);
+  Acceptor::Stats begin = server->acceptStats();
+  TimeStamp start(TimeStamp::now());
+  ::usleep(static_cast<useconds_t>(seconds * 1000 * 1000));
+  Acceptor::Stats end = server->acceptStats();
+  result->seconds = timeDiffInSeconds(TimeStamp::now(), start);
+  result->stats.accepted = end.accepted - begin.accepted;
+  result->stats.wakeups = end.wakeups - begin.wakeups;
+  result->stats.emfile = end.emfile - begin.emfile;
+  g_running = false;
+  for (auto& client : clients) {
+    client->join();
+  }
+  /// wakes the loop up, quit() alone waits for the poll timeout
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+static void bench(int batch, uint16_t port, int numClients, int numThreads,
+                  double seconds) {
+  EventLoop loop;
+  InetAddress listenAddr(port, true);
+  TcpServer server(&loop, listenAddr, "AcceptBench");
+  server.setThreadNum(numThreads);
+  server.setAcceptBatch(batch);
+  server.setConnectionCallback(onConnection);
+  server.start();
+
+  Result result;
+  Thread driver(std::bind(drive, &loop, &server, listenAddr, numClients,
+                          seconds, &result),
+                nullptr, "driver");
+  driver.start();
+  loop.loop();
+  driver.join();
+
+  printf("batch %3d: %9.1f connections per second, %5.2f per wakeup, "
+         "%lld EMFILE\n",
+         batch, static_cast<double>(result.stats.accepted) / result.seconds,
+         result.stats.wakeups > 0
+             ? static_cast<double>(result.stats.accepted) /
+                   static_cast<double>(result.stats.wakeups)
+             : 0.0,
+         static_cast<long long>(result.stats.emfile));
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  int numClients = argc > 1 ? atoi(argv[1]) : 8;
+  int numThreads = argc > 2 ? atoi(argv[2]) : 0;
+  double seconds = argc > 3 ? atof(argv[3]) : 3.0;
+  uint16_t port = static_cast<uint16_t>(argc > 4 ? atoi(argv[4]) : 9981);
+  if (numClients <= 0 || numThreads < 0 || seconds <= 0) {
+    printf("Usage: %s [numClients] [numThreads] [seconds] [port]\n", argv[0]);
+    return 1;
+  }
+  Logger::setLogLevel(Logger::WARN);
+  printf("%d clients, %d IO threads, %.1f seconds each\n", numClients,
+         numThreads, seconds);
+  const int batches[] = {1, Acceptor::kDefaultAcceptBatch, 64};
+  for (int batch : batches) {
+    bench(batch, port, numClients, numThreads, seconds);
+  }
+}
@@ -0,0 +1,144 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+/// Syscalls of the poller per message, epoll against the io_uring poll
+/// backend, see IoUringPoller and EventLoop::Metrics::pollerSyscalls.
+///
+/// Pairs of sockets in one loop pass a small message back and forth.
+/// When toggling, every reply is written from the write callback, so
+/// write interest is enabled and disabled once per message, as
+/// TcpConnection does for output it can't write at once. epoll makes an
+/// epoll_ctl(2) for each change, io_uring submits them with the wait.
+/// Messages are read(2) and written(2) the same way with both, these
+/// calls are not counted.
+
+#include "libel/base/logging.h"
+#include "libel/net/channel.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/poller/io_uring_poller.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+static const size_t kMessageSize = 64;
+
+/// one end of a pair, replies to every message
+class Peer : noncopyable {
+ public:
+  Peer(EventLoop* loop, int fd, bool toggle)
+      : fd_(fd), toggle_(toggle), messages_(0), channel_(loop, fd) {
+    channel_.setReadCallback(std::bind(&Peer::onRead, this));
+    channel_.setWriteCallback(std::bind(&Peer::onWrite, this));
+    channel_.enableReading();
+  }
+
+  ~Peer() {
+    channel_.disableAll();
+    channel_.removeSelfFromLoop();
+    ::close(fd_);
+  }
+
+  void send() {
+    char message[kMessageSize] = {};
+    if (::write(fd_, message, sizeof message) < 0) {
+      LOG_FATAL << "write";
+    }
+  }
+
+  int64_t messages() const { return messages_; }
+
+ private:
+  void onRead() {
+    char message[kMessageSize];
+    if (::read(fd_, message, sizeof message) <= 0) {
+      LOG_FATAL << "read";
+    }
+    ++messages_;
+    if (toggle_) {
+      channel_.enableWriting();
+    } else {
+      send();
+    }
+  }
+
+  void onWrite() {
+    channel_.disableWriting();
+    send();
+  }
+
+  const int fd_;
+  const bool toggle_;
+  int64_t messages_;
+  Channel channel_;
+};
+
+static void bench(bool ioUring, bool toggle, int numPairs, double seconds) {
+  if (ioUring) {
+    ::setenv("LIBEL_USE_IO_URING", "1", 1);
+  } else {
+    ::unsetenv("LIBEL_USE_IO_URING");
+  }
+  EventLoop loop;
+  if (ioUring) {
+    /// the loop fell back to epoll if this fails too
+    std::unique_ptr<Poller> probe(IoUringPoller::create(&loop));
+    if (!probe) {
+      printf("io_uring is not supported\n");
+      return;
+    }
+  }
+  std::vector<std::unique_ptr<Peer>> peers;
+  for (int i = 0; i < numPairs; ++i) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0,
+                     fds) < 0) {
+      LOG_FATAL << "socketpair";
+    }
+    peers.emplace_back(new Peer(&loop, fds[0], toggle));
+    peers.emplace_back(new Peer(&loop, fds[1], toggle));
+    peers.back()->send();
+  }
+  const EventLoop::Metrics begin = loop.metrics();
+  loop.runAfter(seconds, std::bind(&EventLoop::quit, &loop));
+  loop.loop();
+  const EventLoop::Metrics end = loop.metrics();
+
+  int64_t messages = 0;
+  for (const auto& peer : peers) {
+    messages += peer->messages();
+  }
+  const double syscalls =
+      static_cast<double>(end.pollerSyscalls - begin.pollerSyscalls);
+  const double iterations =
+      static_cast<double>(end.iterations - begin.iterations);
+  printf("%-8s %-10s %10.0f messages per second, %6.3f poller syscalls "
+         "per message, %6.1f messages per iteration\n",
+         ioUring ? "io_uring" : "epoll", toggle ? "toggling" : "direct",
+         static_cast<double>(messages) / seconds,
+         syscalls / static_cast<double>(messages),
+         static_cast<double>(messages) / iterations);
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  int numPairs = argc > 1 ? atoi(argv[1]) : 64;
+  double seconds = argc > 2 ? atof(argv[2]) : 3.0;
+  if (numPairs <= 0 || seconds <= 0) {
+    printf("Usage: %s [numPairs] [seconds]\n", argv[0]);
+    return 1;
+  }
+  Logger::setLogLevel(Logger::WARN);
+  printf("%d pairs, %.1f seconds each\n", numPairs, seconds);
+  for (bool toggle : {false, true}) {
+    bench(false, toggle, numPairs, seconds);
+    bench(true, toggle, numPairs, seconds);
+  }
+}
@@ -44,6 +44,8 @@ class RpcClient : noncopyable {
           nullptr, &request, response,
           google::protobuf::NewCallback(this, &RpcClient::solved, response));
     } else {
+      /// a call still in flight is not answered any more
+      channel_->failPendingCalls();
       loop_->quit();
     }
   }
@@ -42,8 +42,10 @@ class RpcClient : noncopyable {
     echo::EchoRequest request;
     request.set_payload("001010");
     echo::EchoResponse* response = new echo::EchoResponse;
+    /// one call at a time, so one controller
+    controller_.Reset();
     stub_.Echo(
-        nullptr, &request, response,
+        &controller_, &request, response,
         google::protobuf::NewCallback(this, &RpcClient::replied, response));
   }
 
@@ -53,10 +55,18 @@ class RpcClient : noncopyable {
       conn->setTcpNoDelay(true);
       channel_->setConnection(conn);
       allConnected_->countDown();
+    } else {
+      channel_->failPendingCalls();
     }
   }
 
   void replied(echo::EchoResponse* response) {
+    if (controller_.Failed()) {
+      LOG_ERROR << "RpcClient " << this << " failed after " << count_
+                << " requests: " << controller_.ErrorText();
+      allFinished_->countDown();
+      return;
+    }
     ++count_;
     if (count_ < kRequests) {
       sendRequest();
@@ -70,6 +80,7 @@ class RpcClient : noncopyable {
   TcpClient client_;
   RpcChannelPtr channel_;
   echo::EchoService::Stub stub_;
+  RpcController controller_;
   CountDownLatch* allConnected_;
   CountDownLatch* allFinished_;
   int count_;
@@ -37,6 +37,8 @@ int main(int argc, char* argv[]) {
   RpcServer server(&loop, listenAddr);
   server.setThreadNum(nThreads);
   server.registerService(&impl);
+  /// a protobuf Arena per batch of messages, off by default
+  if (argc > 3) server.setArenaBlockSize(static_cast<size_t>(atoi(argv[3])));
   server.start();
   loop.loop();
 }
\ No newline at end of file
@@ -0,0 +1,242 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define LIBEL_CHECKSUM_X86 1
+#endif
+
+namespace {
+
+/// reflected 0x1EDC6F41
+const uint32_t kCrc32cPoly = 0x82F63B78;
+
+struct Crc32cTable {
+  Crc32cTable() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int k = 0; k < 8; ++k) {
+        crc = (crc & 1) ? (crc >> 1) ^ kCrc32cPoly : crc >> 1;
+      }
+      table[i] = crc;
+    }
+  }
+  uint32_t table[256];
+};
+
+#ifdef LIBEL_CHECKSUM_X86
+
+/// Operators appending zero bytes to a crc, one table per byte of it,
+/// to combine crcs of consecutive blocks computed in parallel, as in
+/// crc32c.c of Mark Adler.
+struct Crc32cShift {
+  explicit Crc32cShift(size_t zeroBytes) {
+    uint32_t op[32];
+    zerosOperator(op, zeroBytes);
+    for (uint32_t n = 0; n < 256; ++n) {
+      table[0][n] = times(op, n);
+      table[1][n] = times(op, n << 8);
+      table[2][n] = times(op, n << 16);
+      table[3][n] = times(op, n << 24);
+    }
+  }
+
+  uint32_t operator()(uint32_t crc) const {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+           table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+  }
+
+  static uint32_t times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+      if (vec & 1) sum ^= *mat;
+      vec >>= 1;
+      ++mat;
+    }
+    return sum;
+  }
+
+  static void square(uint32_t* result, const uint32_t* mat) {
+    for (int n = 0; n < 32; ++n) result[n] = times(mat, mat[n]);
+  }
+
+  static void zerosOperator(uint32_t* even, size_t len) {
+    uint32_t odd[32];
+    /// one zero bit
+    odd[0] = kCrc32cPoly;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; ++n) {
+      odd[n] = row;
+      row <<= 1;
+    }
+    square(even, odd);  // two zero bits
+    square(odd, even);  // four zero bits
+    /// then one byte, two bytes, ..., applied as len has bits
+    do {
+      square(even, odd);
+      len >>= 1;
+      if (len == 0) return;
+      square(odd, even);
+      len >>= 1;
+    } while (len);
+    memcpy(even, odd, sizeof odd);
+  }
+
+  uint32_t table[4][256];
+};
+
+/// bytes of each of the three streams
+const size_t kLongBlock = 8192;
+const size_t kShortBlock = 256;
+
+inline uint64_t load64(const char* p) {
+  uint64_t word;
+  ::memcpy(&word, p, sizeof word);
+  return word;
+}
+
+/// The crc32 instruction has a latency of 3 cycles and a throughput of
+/// 1, so three independent streams keep it busy, their crcs are
+/// combined by shifting.
+template <size_t kBlock>
+__attribute__((target("sse4.2")))
+inline uint64_t crc32cThreeWay(uint64_t crc, const char*& p, size_t& len,
+                               const Crc32cShift& shift) {
+  while (len >= 3 * kBlock) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    const char* const end = p + kBlock;
+    do {
+      crc = _mm_crc32_u64(crc, load64(p));
+      crc1 = _mm_crc32_u64(crc1, load64(p + kBlock));
+      crc2 = _mm_crc32_u64(crc2, load64(p + 2 * kBlock));
+      p += 8;
+    } while (p < end);
+    crc = shift(static_cast<uint32_t>(crc)) ^ crc1;
+    crc = shift(static_cast<uint32_t>(crc)) ^ crc2;
+    p += 2 * kBlock;
+    len -= 3 * kBlock;
+  }
+  return crc;
+}
+
+__attribute__((target("sse4.2")))
+uint32_t crc32cSse42(uint32_t crc, const void* data, size_t len) {
+  static const Crc32cShift longShift(kLongBlock);
+  static const Crc32cShift shortShift(kShortBlock);
+  const char* p = static_cast<const char*>(data);
+  uint64_t crc64 = ~crc;
+  crc64 = crc32cThreeWay<kLongBlock>(crc64, p, len, longShift);
+  crc64 = crc32cThreeWay<kShortBlock>(crc64, p, len, shortShift);
+  while (len >= 8) {
+    crc64 = _mm_crc32_u64(crc64, load64(p));
+    p += 8;
+    len -= 8;
+  }
+  uint32_t crc32 = static_cast<uint32_t>(crc64);
+  while (len > 0) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*p));
+    ++p;
+    --len;
+  }
+  return ~crc32;
+}
+
+bool hasSse42() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+}
+
+#endif
+
+const uint32_t kPrime1 = 2654435761U;
+const uint32_t kPrime2 = 2246822519U;
+const uint32_t kPrime3 = 3266489917U;
+const uint32_t kPrime4 = 668265263U;
+const uint32_t kPrime5 = 374761393U;
+
+inline uint32_t rotl(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+inline uint32_t read32(const char* p) {
+  uint32_t v;
+  ::memcpy(&v, p, sizeof v);
+  return v;  // little endian, as x86 is
+}
+
+inline uint32_t round32(uint32_t acc, uint32_t input) {
+  acc += input * kPrime2;
+  acc = rotl(acc, 13);
+  return acc * kPrime1;
+}
+
+}  // namespace
+
+namespace Libel {
+
+namespace Util {
+
+uint32_t crc32cSoftware(uint32_t crc, const void* data, size_t len) {
+  static const Crc32cTable crcTable;
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) {
+    crc = crcTable.table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+#ifdef LIBEL_CHECKSUM_X86
+  static const bool sse42 = hasSse42();
+  if (sse42) return crc32cSse42(crc, data, len);
+#endif
+  return crc32cSoftware(crc, data, len);
+}
+
+uint32_t xxHash32(const void* data, size_t len, uint32_t seed) {
+  const char* p = static_cast<const char*>(data);
+  const char* const end = p + len;
+  uint32_t h32;
+  if (len >= 16) {
+    const char* const limit = end - 16;
+    uint32_t v1 = seed + kPrime1 + kPrime2;
+    uint32_t v2 = seed + kPrime2;
+    uint32_t v3 = seed;
+    uint32_t v4 = seed - kPrime1;
+    do {
+      v1 = round32(v1, read32(p));
+      v2 = round32(v2, read32(p + 4));
+      v3 = round32(v3, read32(p + 8));
+      v4 = round32(v4, read32(p + 12));
+      p += 16;
+    } while (p <= limit);
+    h32 = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+  } else {
+    h32 = seed + kPrime5;
+  }
+  h32 += static_cast<uint32_t>(len);
+  while (end - p >= 4) {
+    h32 += read32(p) * kPrime3;
+    h32 = rotl(h32, 17) * kPrime4;
+    p += 4;
+  }
+  while (p < end) {
+    h32 += static_cast<unsigned char>(*p) * kPrime5;
+    h32 = rotl(h32, 11) * kPrime1;
+    ++p;
+  }
+  h32 ^= h32 >> 15;
+  h32 *= kPrime2;
+  h32 ^= h32 >> 13;
+  h32 *= kPrime3;
+  h32 ^= h32 >> 16;
+  return h32;
+}
+
+}  // namespace Util
+}  // namespace Libel
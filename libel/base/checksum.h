@@ -0,0 +1,28 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_CHECKSUM_H
+#define LIBEL_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Libel {
+
+namespace Util {
+
+/// CRC-32C (Castagnoli) of data, continuing from crc, 0 to start.
+/// The crc32 instruction of SSE4.2 is used if the CPU has it.
+uint32_t crc32c(uint32_t crc, const void* data, size_t len);
+
+/// crc32c() without SSE4.2, for tests
+uint32_t crc32cSoftware(uint32_t crc, const void* data, size_t len);
+
+/// XXH32 of xxHash
+uint32_t xxHash32(const void* data, size_t len, uint32_t seed = 0);
+
+}  // namespace Util
+}  // namespace Libel
+
+#endif  // LIBEL_CHECKSUM_H
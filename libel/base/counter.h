@@ -0,0 +1,40 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_COUNTER_H
+#define LIBEL_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace Libel {
+
+namespace Util {
+
+/// Statistics counters written by one thread, e.g. the loop thread, and
+/// read by any. With a single writer a relaxed load and store is enough,
+/// no locked instruction like fetch_add on the hot path.
+
+inline void add(std::atomic<int64_t>& counter, int64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+/// keeps the maximum of values
+inline void raise(std::atomic<int64_t>& maximum, int64_t value) {
+  if (value > maximum.load(std::memory_order_relaxed)) {
+    maximum.store(value, std::memory_order_relaxed);
+  }
+}
+
+/// for readers in any thread
+inline int64_t load(const std::atomic<int64_t>& counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+}  // namespace Util
+
+}  // namespace Libel
+
+#endif  // LIBEL_COUNTER_H
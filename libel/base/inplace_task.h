@@ -0,0 +1,163 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_INPLACE_TASK_H
+#define LIBEL_INPLACE_TASK_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Libel {
+
+/// Move-only replacement of std::function<void()> with small buffer.
+///
+/// Callables up to kInlineSize bytes(a std::bind of a member function,
+/// a shared_ptr and a std::string for example) are stored inline, so
+/// constructing, moving and destroying an InplaceTask never calls malloc.
+/// Bigger ones, or ones which may throw when moved, fall back to heap.
+///
+/// Being move-only, it also accepts callables which can't be copied,
+/// e.g. lambdas capturing a std::unique_ptr.
+class InplaceTask {
+ public:
+  static const size_t kInlineSize = 64;
+
+  InplaceTask() noexcept : ops_(nullptr) {}
+  InplaceTask(std::nullptr_t) noexcept : ops_(nullptr) {}
+
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<F>::type, InplaceTask>::value>::type>
+  InplaceTask(F&& f) : ops_(nullptr) {
+    typedef typename std::decay<F>::type Callable;
+    construct<Callable>(std::forward<F>(f),
+                        std::integral_constant<bool, fitsInline<Callable>()>());
+  }
+
+  InplaceTask(InplaceTask&& rhs) noexcept : ops_(rhs.ops_) {
+    if (ops_) {
+      ops_->move(&storage_, &rhs.storage_);
+      rhs.ops_ = nullptr;
+    }
+  }
+
+  InplaceTask& operator=(InplaceTask&& rhs) noexcept {
+    if (this != &rhs) {
+      reset();
+      if (rhs.ops_) {
+        rhs.ops_->move(&storage_, &rhs.storage_);
+        ops_ = rhs.ops_;
+        rhs.ops_ = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  InplaceTask& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  InplaceTask(const InplaceTask&) = delete;
+  InplaceTask& operator=(const InplaceTask&) = delete;
+
+  ~InplaceTask() { reset(); }
+
+  /// like std::function, calls the callable as a non-const object
+  void operator()() const {
+    assert(ops_ != nullptr);
+    ops_->invoke(&storage_);
+  }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  /// false if the callable lives on heap, for tests
+  bool isInline() const noexcept { return ops_ != nullptr && ops_->isInline; }
+
+  void swap(InplaceTask& rhs) noexcept {
+    InplaceTask tmp(std::move(rhs));
+    rhs = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  template <typename F>
+  static constexpr bool fitsInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(Storage) &&
+           std::is_nothrow_move_constructible<F>::value;
+  }
+
+ private:
+  typedef std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type
+      Storage;
+
+  struct Ops {
+    void (*invoke)(void* storage);
+    /// move constructs dst from src, and destroys src
+    void (*move)(void* dst, void* src);
+    void (*destroy)(void* storage);
+    bool isInline;
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static void invoke(void* storage) { (*static_cast<F*>(storage))(); }
+    static void move(void* dst, void* src) {
+      F* from = static_cast<F*>(src);
+      ::new (dst) F(std::move(*from));
+      from->~F();
+    }
+    static void destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+    static const Ops ops;
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& pointer(void* storage) { return *static_cast<F**>(storage); }
+    static void invoke(void* storage) { (*pointer(storage))(); }
+    static void move(void* dst, void* src) {
+      ::new (dst) F*(pointer(src));
+    }
+    static void destroy(void* storage) { delete pointer(storage); }
+    static const Ops ops;
+  };
+
+  template <typename Callable, typename F>
+  void construct(F&& f, std::true_type /* inline */) {
+    ::new (&storage_) Callable(std::forward<F>(f));
+    ops_ = &InlineOps<Callable>::ops;
+  }
+
+  template <typename Callable, typename F>
+  void construct(F&& f, std::false_type /* inline */) {
+    ::new (&storage_) Callable*(new Callable(std::forward<F>(f)));
+    ops_ = &HeapOps<Callable>::ops;
+  }
+
+  void reset() noexcept {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  mutable Storage storage_;
+  const Ops* ops_;
+};
+
+template <typename F>
+const InplaceTask::Ops InplaceTask::InlineOps<F>::ops = {
+    &InplaceTask::InlineOps<F>::invoke, &InplaceTask::InlineOps<F>::move,
+    &InplaceTask::InlineOps<F>::destroy, true};
+
+template <typename F>
+const InplaceTask::Ops InplaceTask::HeapOps<F>::ops = {
+    &InplaceTask::HeapOps<F>::invoke, &InplaceTask::HeapOps<F>::move,
+    &InplaceTask::HeapOps<F>::destroy, false};
+
+}  // namespace Libel
+
+#endif  // LIBEL_INPLACE_TASK_H
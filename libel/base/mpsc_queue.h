@@ -0,0 +1,93 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_MPSC_QUEUE_H
+#define LIBEL_MPSC_QUEUE_H
+
+#include "libel/base/noncopyable.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace Libel {
+
+/// link of an intrusive MpscQueue, embed it by inheritance.
+struct MpscNode {
+  MpscNode() : next(nullptr) {}
+  std::atomic<MpscNode*> next;
+};
+
+/// Intrusive, lock-free multi-producer single-consumer queue,
+/// modeled after Dmitry Vyukov's non-intrusive MPSC node-based queue.
+///
+/// push() is wait-free and may be called from any thread,
+/// pop() must be called from one consumer thread only.
+/// pop() may return nullptr while a producer is in the middle of
+/// push(), caller should retry later(e.g. on next wakeup).
+///
+/// The queue doesn't own the nodes.
+template <typename T>
+class MpscQueue : noncopyable {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_), size_(0) {}
+
+  void push(T* node) {
+    // count first, so that size() never underflows
+    size_.fetch_add(1, std::memory_order_relaxed);
+    pushNode(node);
+  }
+
+  /// consumer only
+  T* pop() {
+    MpscNode* tail = tail_;
+    MpscNode* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) return nullptr;
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      tail_ = next;
+      return popped(tail);
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // a producer has swapped head_ but not linked it yet
+      return nullptr;
+    }
+    pushNode(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      tail_ = next;
+      return popped(tail);
+    }
+    return nullptr;
+  }
+
+  /// approximate when producers are running
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  void pushNode(MpscNode* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  T* popped(MpscNode* node) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return static_cast<T*>(node);
+  }
+
+  std::atomic<MpscNode*> head_;  // producers side
+  MpscNode* tail_;               // consumer side
+  MpscNode stub_;
+  std::atomic<size_t> size_;
+};
+
+}  // namespace Libel
+
+#endif  // LIBEL_MPSC_QUEUE_H
@@ -0,0 +1,59 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_STRING_PIECE_H
+#define LIBEL_STRING_PIECE_H
+
+#include <strings.h>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace Libel {
+
+///
+/// Non-owning view of bytes, std::string_view for C++11.
+/// The bytes must outlive it.
+///
+class StringPiece {
+ public:
+  StringPiece() : ptr_(nullptr), length_(0) {}
+  StringPiece(const char* str) : ptr_(str), length_(strlen(str)) {}
+  StringPiece(const std::string& str)
+      : ptr_(str.data()), length_(str.size()) {}
+  StringPiece(const char* offset, size_t len) : ptr_(offset), length_(len) {}
+
+  const char* data() const { return ptr_; }
+  size_t size() const { return length_; }
+  bool empty() const { return length_ == 0; }
+  const char* begin() const { return ptr_; }
+  const char* end() const { return ptr_ + length_; }
+
+  char operator[](size_t i) const { return ptr_[i]; }
+
+  bool equalsIgnoreCase(const StringPiece& x) const {
+    return length_ == x.length_ &&
+           (length_ == 0 || ::strncasecmp(ptr_, x.ptr_, length_) == 0);
+  }
+
+  bool operator==(const StringPiece& x) const {
+    return length_ == x.length_ &&
+           (length_ == 0 || memcmp(ptr_, x.ptr_, length_) == 0);
+  }
+  bool operator!=(const StringPiece& x) const { return !(*this == x); }
+
+  std::string as_string() const { return std::string(ptr_, length_); }
+
+ private:
+  const char* ptr_;
+  size_t length_;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const StringPiece& piece) {
+  return o.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+}
+
+}  // namespace Libel
+
+#endif  // LIBEL_STRING_PIECE_H
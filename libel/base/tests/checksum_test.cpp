@@ -0,0 +1,60 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/checksum.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace Libel::Util;
+
+void testCrc32c() {
+  const char* check = "123456789";
+  assert(crc32c(0, check, strlen(check)) == 0xE3069283);
+  assert(crc32cSoftware(0, check, strlen(check)) == 0xE3069283);
+  (void)check;
+  assert(crc32c(0, "", 0) == 0);
+  /// 32 bytes of zeros, from RFC 3720
+  char zeros[32] = {};
+  assert(crc32c(0, zeros, sizeof zeros) == 0x8A9136AA);
+  (void)zeros;
+
+  /// every length and alignment agrees with the table and is incremental
+  std::string data;
+  for (int i = 0; i < 300; ++i) data.push_back(static_cast<char>(i * 7 + 3));
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t len = 0; offset + len <= data.size(); len += 13) {
+      const char* p = data.data() + offset;
+      uint32_t crc = crc32c(0, p, len);
+      assert(crc == crc32cSoftware(0, p, len));
+      assert(crc == crc32c(crc32c(0, p, len / 2), p + len / 2, len - len / 2));
+      (void)crc;
+    }
+  }
+  /// long enough for the three-way streams of both block sizes
+  for (int i = 0; i < 100000; ++i) data.push_back(static_cast<char>(i * 131 + i / 7));
+  for (size_t len : {768, 769, 24576, 24576 + 768 + 9, 100300}) {
+    assert(crc32c(0, data.data() + 1, len) == crc32cSoftware(0, data.data() + 1, len));
+    (void)len;
+  }
+}
+
+void testXxHash32() {
+  assert(xxHash32("", 0) == 0x02CC5D05);
+  assert(xxHash32("a", 1) == 0x550D7456);
+  assert(xxHash32("abc", 3) == 0x32D153FF);
+  const char* fox = "The quick brown fox jumps over the lazy dog";
+  assert(xxHash32(fox, strlen(fox)) == 0xE85EA4DE);
+  (void)fox;
+  assert(xxHash32("abc", 3, 1) != xxHash32("abc", 3));
+}
+
+int main() {
+  testCrc32c();
+  testXxHash32();
+  printf("checksum_test passed\n");
+  return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/inplace_task.h"
+#include "libel/base/threadpool.h"
+#include "libel/base/countdown_latch.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace Libel;
+
+/// counts operator new calls of this process
+std::atomic<int> g_numNews(0);
+
+void* operator new(size_t size) {
+  ++g_numNews;
+  void* p = ::malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { ::free(p); }
+
+void operator delete(void* p, size_t) noexcept { ::free(p); }
+
+struct Connection {
+  void sendInLoop(const std::string& message) { sent += message; }
+  std::string sent;
+};
+
+void testInline() {
+  auto conn = std::make_shared<Connection>();
+  std::string message(100, 'x');
+  int before = g_numNews;
+  (void)before;
+  InplaceTask empty;
+  assert(!empty);
+  /// the shape of TcpConnection::send() and TcpServer::removeConnection()
+  InplaceTask task(std::bind(&Connection::sendInLoop, conn.get(), std::move(message)));
+  InplaceTask task2(std::bind(&Connection::sendInLoop, conn, std::string()));
+  assert(g_numNews == before);
+  assert(task.isInline() && task2.isInline());
+
+  InplaceTask moved(std::move(task));
+  assert(!task);
+  assert(moved.isInline());
+  assert(g_numNews == before);
+  moved();
+  moved();
+  task2();
+  assert(conn->sent == std::string(200, 'x'));
+  moved = nullptr;
+  assert(!moved);
+}
+
+void testHeap() {
+  char big[InplaceTask::kInlineSize + 1] = {'a'};
+  int count = 0;
+  InplaceTask task([big, &count]() { count += big[0]; });
+  assert(!task.isInline());
+  InplaceTask other;
+  int before = g_numNews;
+  (void)before;
+  other = std::move(task);  // just steals the pointer
+  assert(g_numNews == before);
+  other();
+  assert(count == 'a');
+}
+
+void testMoveOnlyAndDestroy() {
+  auto counter = std::make_shared<int>(0);
+  std::unique_ptr<int> owned(new int(42));
+  {
+    InplaceTask task([counter]() { ++*counter; });
+    assert(counter.use_count() == 2);
+    InplaceTask task2(std::move(task));
+    assert(counter.use_count() == 2);
+    task2();
+    task.swap(task2);
+    task();
+  }
+  assert(*counter == 2);
+  assert(counter.use_count() == 1);
+
+  /// std::function can't hold it
+  struct Owner {
+    void operator()() const { assert(*p == 42); }
+    std::unique_ptr<int> p;
+  };
+  InplaceTask task(Owner{std::move(owned)});
+  task();
+}
+
+void testThreadPool() {
+  ThreadPool pool("InplaceTaskPool");
+  pool.start(2);
+  CountDownLatch latch(100);
+  for (int i = 0; i < 100; ++i) {
+    pool.run([&latch]() { latch.countDown(); });
+  }
+  latch.wait();
+  pool.stop();
+}
+
+int main() {
+  testInline();
+  testHeap();
+  testMoveOnlyAndDestroy();
+  testThreadPool();
+  return 0;
+}
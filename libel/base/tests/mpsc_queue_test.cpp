@@ -0,0 +1,84 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/mpsc_queue.h"
+#include "libel/base/Thread.h"
+
+#include <cassert>
+#include <vector>
+
+using namespace Libel;
+
+struct Item : MpscNode {
+  Item(int p, int s) : producer(p), seq(s) {}
+  int producer;
+  int seq;
+};
+
+const int kProducers = 4;
+const int kItemsPerProducer = 100000;
+
+MpscQueue<Item> g_queue;
+std::atomic<int> g_started(0);
+
+void producer(void* arg) {
+  int id = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+  ++g_started;
+  while (g_started < kProducers) {
+  }
+  for (int i = 0; i < kItemsPerProducer; ++i) {
+    g_queue.push(new Item(id, i));
+  }
+}
+
+void testSingleThread() {
+  MpscQueue<Item> queue;
+  assert(queue.empty());
+  assert(queue.pop() == nullptr);
+  Item a(0, 1), b(0, 2), c(0, 3);
+  queue.push(&a);
+  queue.push(&b);
+  assert(queue.size() == 2);
+  assert(queue.pop() == &a);
+  queue.push(&c);
+  assert(queue.pop() == &b);
+  assert(queue.pop() == &c);
+  assert(queue.pop() == nullptr);
+  assert(queue.empty());
+  /// nodes can be reused after popped
+  queue.push(&a);
+  assert(queue.pop() == &a);
+  assert(queue.pop() == nullptr);
+}
+
+void testMultiProducers() {
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kProducers; ++i) {
+    threads.emplace_back(new Thread(producer, reinterpret_cast<void*>(i)));
+    threads.back()->start();
+  }
+  std::vector<int> expected(kProducers, 0);
+  int total = 0;
+  while (total < kProducers * kItemsPerProducer) {
+    Item* item = g_queue.pop();
+    if (item) {
+      /// FIFO for each producer
+      assert(item->seq == expected[item->producer]);
+      ++expected[item->producer];
+      ++total;
+      delete item;
+    }
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  assert(g_queue.pop() == nullptr);
+  assert(g_queue.empty());
+}
+
+int main() {
+  testSingleThread();
+  testMultiProducers();
+  return 0;
+}
@@ -72,7 +72,7 @@ ThreadPool::Task ThreadPool::take() {
     }
     Task task;
     if (!queue_.empty()) {
-        task = queue_.front();
+        task = std::move(queue_.front());
         queue_.pop_front();
         if (maxQueueSize_ > 0)
             notFull_.notify();
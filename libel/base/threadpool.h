@@ -6,6 +6,7 @@
 #define LIBEL_THREADPOOL_H
 
 #include "libel/base/condition.h"
+#include "libel/base/inplace_task.h"
 #include "libel/base/Mutex.h"
 #include "libel/base/Thread.h"
 
@@ -16,14 +17,16 @@ namespace Libel {
 
 class ThreadPool : noncopyable {
 public:
-    typedef std::function<void ()> Task;
+    /// move-only, small tasks are queued without heap allocation
+    typedef InplaceTask Task;
+    typedef std::function<void ()> ThreadInitCallback;
 
     explicit ThreadPool(std::string nameArg = std::string("ThreadPool"));
     ~ThreadPool();
 
     void setMaxQueueSize(int maxSize) { maxQueueSize_ = maxSize;}
 
-    void setThreadInitCallback(const Task &cb) { threadInitCallback_ = cb; }
+    void setThreadInitCallback(const ThreadInitCallback &cb) { threadInitCallback_ = cb; }
 
     void start(int numThreads);
 
@@ -44,7 +47,7 @@ private:
     Condition notEmpty_ GUARDED_BY(mutex_);
     Condition notFull_ GUARDED_BY(mutex_);
     std::string name_;
-    Task threadInitCallback_;
+    ThreadInitCallback threadInitCallback_;
     std::vector<std::unique_ptr<Libel::Thread>> threads_;
     std::deque<Task> queue_ GUARDED_BY(mutex_);
     size_t maxQueueSize_;
@@ -5,6 +5,7 @@
 #include "libel/base/timestamp.h"
 
 #include <sys/time.h>
+#include <time.h>
 #include <cinttypes>
 #include <cstdio>
 
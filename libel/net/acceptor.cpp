@@ -4,6 +4,7 @@
 
 #include "libel/net/acceptor.h"
 
+#include "libel/base/counter.h"
 #include "libel/base/logging.h"
 #include "libel/net/eventloop.h"
 #include "libel/net/inet_address.h"
@@ -16,13 +17,19 @@
 using namespace Libel;
 using namespace Libel::net;
 
+const int Acceptor::kDefaultAcceptBatch;
+
 Acceptor::Acceptor(Libel::net::EventLoop *loop,
                    const Libel::net::InetAddress &listenAddr, bool reusePort)
     : loop_(loop),
       acceptSocket_(sockets::createNonBlockingSocketOrDie(listenAddr.family())),
       acceptChannel_(loop, acceptSocket_.fd()),
       isListening_(false),
-      idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
+      idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+      acceptBatch_(kDefaultAcceptBatch),
+      numAccepted_(0),
+      numWakeups_(0),
+      numEmfile_(0) {
   assert(idleFd_ >= 0);
   acceptSocket_.setReuseAddr(true);
   acceptSocket_.setReusePort(reusePort);
@@ -45,18 +52,25 @@ void Acceptor::listen() {
 
 void Acceptor::handleRead() {
   loop_->assertInLoopThread();
-  InetAddress peerAddr;
-  int connfd = acceptSocket_.accept(&peerAddr);
-  if (connfd >= 0) {
-    if (newConnectionCallback_)
-      newConnectionCallback_(connfd, peerAddr);
-    else
-      sockets::close(connfd);
-  } else {
+  Util::add(numWakeups_, 1);
+  for (int i = 0; i < acceptBatch_; ++i) {
+    InetAddress peerAddr;
+    int connfd = acceptSocket_.accept(&peerAddr);
+    if (connfd >= 0) {
+      Util::add(numAccepted_, 1);
+      if (newConnectionCallback_)
+        newConnectionCallback_(connfd, peerAddr);
+      else
+        sockets::close(connfd);
+      continue;
+    }
+    /// backlog drained
+    if (errno == EAGAIN) break;
     LOG_ERROR << "failed to call accept in Acceptor::handleRead";
     /// refer "The special problem of accept()ing when you cant"
     /// in libev's doc.
     if (errno == EMFILE) {
+      Util::add(numEmfile_, 1);
       /// in case of cpu busy loop, we reserve a idle fd
       /// when process runs out of fd, use this fd as tmp,
       /// but close the connection just after accept
@@ -67,6 +81,15 @@ void Acceptor::handleRead() {
       /// ::open will fail.
       idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
     }
+    /// level triggered, the rest comes with the next event
+    break;
   }
 }
 
+Acceptor::Stats Acceptor::stats() const {
+  Stats stats;
+  stats.accepted = Util::load(numAccepted_);
+  stats.wakeups = Util::load(numWakeups_);
+  stats.emfile = Util::load(numEmfile_);
+  return stats;
+}
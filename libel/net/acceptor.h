@@ -9,6 +9,8 @@
 #include "libel/net/sockets_ops.h"
 #include "libel/net/socket.h"
 
+#include <cassert>
+#include <atomic>
 #include <functional>
 
 namespace Libel {
@@ -19,10 +21,24 @@ class EventLoop;
 class InetAddress;
 
 /// Acceptor of incoming TCP connections.
+///
+/// Drains the listen backlog on each readable event, up to acceptBatch()
+/// connections, so that a connection storm costs one poll per batch
+/// instead of one per connection, while other channels of the loop
+/// still get their turn.
 class Acceptor : noncopyable {
 public:
   using NewConnectionCallback = std::function<void (int sockfd, const InetAddress&)>;
 
+  static const int kDefaultAcceptBatch = 16;
+
+  /// counters since construction, readable from any thread
+  struct Stats {
+    int64_t accepted;   // connections accepted
+    int64_t wakeups;    // readable events handled
+    int64_t emfile;     // accept failed with EMFILE
+  };
+
   Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reusePort);
   ~Acceptor();
 
@@ -34,6 +50,16 @@ public:
 
   bool isListening() const { return isListening_; }
 
+  /// at most batch connections accepted per readable event,
+  /// 1 accepts one per event. Not thread safe, call before listen().
+  void setAcceptBatch(int batch) {
+    assert(batch > 0);
+    acceptBatch_ = batch;
+  }
+  int acceptBatch() const { return acceptBatch_; }
+
+  Stats stats() const;
+
 private:
   void handleRead();
 
@@ -43,6 +69,11 @@ private:
   NewConnectionCallback newConnectionCallback_;
   bool isListening_;
   int idleFd_;
+  int acceptBatch_;
+  /// written in loop thread only
+  std::atomic<int64_t> numAccepted_;
+  std::atomic<int64_t> numWakeups_;
+  std::atomic<int64_t> numEmfile_;
 };
 
 }
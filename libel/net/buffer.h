@@ -7,6 +7,7 @@
 
 #include "libel/net/Endian.h"
 #include "libel/net/callbacks.h"
+#include "libel/net/char_scanner.h"
 
 #include <algorithm>
 #include <vector>
@@ -61,28 +62,25 @@ class Buffer {
     return begin() + readerIndex_;
   }
 
+  /// vectorized, see CharScanner
   const char *findCRLF() const {
-    const char* crlf = std::search(peek(), beginWrite(), kCRLF, kCRLF+2);
-    return crlf == beginWrite() ? nullptr : crlf;
+    return CharScanner::findCRLF(peek(), beginWrite());
   }
 
   const char* findCRLF(const char* start) const {
     assert(peek() <= start);
     assert(start <= beginWrite());
-    const char* crlf = std::search(start, beginWrite(), kCRLF, kCRLF + 2);
-    return crlf == beginWrite() ? nullptr : crlf;
+    return CharScanner::findCRLF(start, beginWrite());
   }
 
   const char* findEOL() const {
-    const void* eol = memchr(peek(), '\n', readableBytes());
-    return static_cast<const char*>(eol);
+    return CharScanner::findChar(peek(), beginWrite(), '\n');
   }
 
   const char* findEOL(const char* start) const {
     assert(peek() <= start);
     assert(start <= beginWrite());
-    const void *eol = memchr(start, '\n', beginWrite() - start);
-    return static_cast<const char*>(eol);
+    return CharScanner::findChar(start, beginWrite(), '\n');
   }
 
   void retrieveAll() {
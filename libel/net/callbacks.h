@@ -5,6 +5,7 @@
 #ifndef LIBEL_CALLBACKS_H
 #define LIBEL_CALLBACKS_H
 
+#include "libel/base/inplace_task.h"
 #include "libel/base/timestamp.h"
 
 #include <functional>
@@ -113,7 +114,7 @@ namespace net {
 class Buffer;
 class TcpConnection;
 using TcpConnectionPtr = std::shared_ptr<TcpConnection>;
-using TimerCallback = std::function<void()>;
+using TimerCallback = InplaceTask;
 using ConnectionCallback = std::function<void (const TcpConnectionPtr&)>;
 using CloseCallback = std::function<void (const TcpConnectionPtr&)>;
 using WriteCompleteCallback = std::function<void (const TcpConnectionPtr&)>;
@@ -0,0 +1,268 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/chain_buffer.h"
+#include "libel/net/callbacks.h"
+#include "libel/net/sockets_ops.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sys/uio.h>
+
+using namespace Libel;
+using namespace Libel::net;
+using namespace Libel::net::detail;
+
+const size_t ChainBuffer::kCheapPrepend;
+const size_t ChainBuffer::kSlabSize;
+const int ChainBuffer::kMaxReadSlabs;
+
+SlabPool::~SlabPool() {
+  while (freeList_) {
+    Slab* slab = freeList_;
+    freeList_ = slab->next;
+    delete slab;
+  }
+}
+
+SlabPool& SlabPool::instance() {
+  static thread_local SlabPool pool;
+  return pool;
+}
+
+Slab* SlabPool::allocate() {
+  Slab* slab = freeList_;
+  if (slab) {
+    freeList_ = slab->next;
+    --numCached_;
+  } else {
+    /// no value-initialization, data is never read before written
+    slab = new Slab;
+  }
+  slab->next = nullptr;
+  slab->readIndex = 0;
+  slab->writeIndex = 0;
+  return slab;
+}
+
+void SlabPool::deallocate(Slab* slab) {
+  if (numCached_ < kMaxCachedSlabs) {
+    slab->next = freeList_;
+    freeList_ = slab;
+    ++numCached_;
+  } else {
+    delete slab;
+  }
+}
+
+ChainBuffer::ChainBuffer(ChainBuffer&& rhs) noexcept
+    : head_(rhs.head_),
+      tail_(rhs.tail_),
+      readable_(rhs.readable_),
+      numSlabs_(rhs.numSlabs_) {
+  rhs.head_ = nullptr;
+  rhs.tail_ = nullptr;
+  rhs.readable_ = 0;
+  rhs.numSlabs_ = 0;
+}
+
+ChainBuffer& ChainBuffer::operator=(ChainBuffer&& rhs) noexcept {
+  if (this != &rhs) {
+    releaseAll();
+    swap(rhs);
+  }
+  return *this;
+}
+
+void ChainBuffer::swap(ChainBuffer& rhs) {
+  std::swap(head_, rhs.head_);
+  std::swap(tail_, rhs.tail_);
+  std::swap(readable_, rhs.readable_);
+  std::swap(numSlabs_, rhs.numSlabs_);
+}
+
+const char* ChainBuffer::pullup(size_t len) {
+  assert(len <= readableBytes());
+  assert(len <= kSlabSize);
+  if (len <= contiguousBytes()) {
+    return peek();
+  }
+  Slab* slab = SlabPool::instance().allocate();
+  // keep cheap prepend room if possible, just like a fresh buffer
+  size_t offset = len + kCheapPrepend <= kSlabSize ? kCheapPrepend : 0;
+  slab->readIndex = offset;
+  slab->writeIndex = offset;
+  copyOut(slab->beginWrite(), len);
+  slab->writeIndex += len;
+  retrieve(len);
+
+  slab->next = head_;
+  head_ = slab;
+  if (!tail_) tail_ = slab;
+  ++numSlabs_;
+  readable_ += len;
+  return peek();
+}
+
+void ChainBuffer::copyOut(void* dest, size_t len) const {
+  assert(len <= readableBytes());
+  auto d = static_cast<char*>(dest);
+  for (const Slab* slab = head_; len > 0; slab = slab->next) {
+    assert(slab != nullptr);
+    size_t n = std::min(len, slab->readableBytes());
+    ::memcpy(d, slab->peek(), n);
+    d += n;
+    len -= n;
+  }
+}
+
+void ChainBuffer::retrieve(size_t len) {
+  assert(len <= readableBytes());
+  readable_ -= len;
+  while (len > 0) {
+    size_t n = std::min(len, head_->readableBytes());
+    head_->readIndex += n;
+    len -= n;
+    if (head_->readableBytes() == 0) {
+      Slab* slab = head_;
+      head_ = slab->next;
+      if (!head_) tail_ = nullptr;
+      --numSlabs_;
+      SlabPool::instance().deallocate(slab);
+    }
+  }
+}
+
+void ChainBuffer::append(const char* data, size_t len) {
+  while (len > 0) {
+    if (!tail_ || tail_->writableBytes() == 0) {
+      Slab* slab = SlabPool::instance().allocate();
+      if (!head_) {
+        slab->readIndex = kCheapPrepend;
+        slab->writeIndex = kCheapPrepend;
+      }
+      linkTail(slab);
+    }
+    size_t n = std::min(len, tail_->writableBytes());
+    ::memcpy(tail_->beginWrite(), data, n);
+    tail_->writeIndex += n;
+    readable_ += n;
+    data += n;
+    len -= n;
+  }
+}
+
+void ChainBuffer::prepend(const void* data, size_t len) {
+  auto d = static_cast<const char*>(data);
+  /// fill from the end of data, slab by slab towards the front
+  while (len > 0) {
+    if (!head_ || head_->readIndex == 0) {
+      Slab* slab = SlabPool::instance().allocate();
+      slab->readIndex = kSlabSize;
+      slab->writeIndex = kSlabSize;
+      slab->next = head_;
+      head_ = slab;
+      if (!tail_) tail_ = slab;
+      ++numSlabs_;
+    }
+    size_t n = std::min(len, head_->readIndex);
+    head_->readIndex -= n;
+    ::memcpy(head_->peek(), d + len - n, n);
+    readable_ += n;
+    len -= n;
+  }
+}
+
+int ChainBuffer::peekIovec(struct iovec* iov, int maxIov) const {
+  int cnt = 0;
+  for (Slab* slab = head_; slab && cnt < maxIov; slab = slab->next) {
+    iov[cnt].iov_base = slab->peek();
+    iov[cnt].iov_len = slab->readableBytes();
+    ++cnt;
+  }
+  return cnt;
+}
+
+ssize_t ChainBuffer::readFd(int fd, int* savedErrno) {
+  SlabPool& pool = SlabPool::instance();
+  struct iovec vec[kMaxReadSlabs + 1];
+  Slab* fresh[kMaxReadSlabs];
+  int iovcnt = 0;
+  const size_t tailWritable = tail_ ? tail_->writableBytes() : 0;
+  if (tailWritable > 0) {
+    vec[iovcnt].iov_base = tail_->beginWrite();
+    vec[iovcnt].iov_len = tailWritable;
+    ++iovcnt;
+  }
+  for (int i = 0; i < kMaxReadSlabs; ++i) {
+    fresh[i] = pool.allocate();
+    if (i == 0 && !head_) {
+      fresh[i]->readIndex = kCheapPrepend;
+      fresh[i]->writeIndex = kCheapPrepend;
+    }
+    vec[iovcnt].iov_base = fresh[i]->beginWrite();
+    vec[iovcnt].iov_len = fresh[i]->writableBytes();
+    ++iovcnt;
+  }
+
+  const ssize_t n = sockets::readv(fd, vec, iovcnt);
+  if (n < 0) {
+    *savedErrno = errno;
+  }
+  size_t remaining = n > 0 ? implicit_cast<size_t>(n) : 0;
+  readable_ += remaining;
+  if (tailWritable > 0) {
+    size_t used = std::min(remaining, tailWritable);
+    tail_->writeIndex += used;
+    remaining -= used;
+  }
+  for (int i = 0; i < kMaxReadSlabs; ++i) {
+    if (remaining > 0) {
+      size_t used = std::min(remaining, fresh[i]->writableBytes());
+      fresh[i]->writeIndex += used;
+      remaining -= used;
+      linkTail(fresh[i]);
+    } else {
+      pool.deallocate(fresh[i]);
+    }
+  }
+  return n;
+}
+
+ssize_t ChainBuffer::writeFd(int fd, int* savedErrno) {
+  const int kMaxIov = 64;
+  struct iovec vec[kMaxIov];
+  int iovcnt = peekIovec(vec, kMaxIov);
+  if (iovcnt == 0) return 0;
+  const ssize_t n = sockets::writev(fd, vec, iovcnt);
+  if (n < 0) {
+    *savedErrno = errno;
+  } else {
+    retrieve(implicit_cast<size_t>(n));
+  }
+  return n;
+}
+
+void ChainBuffer::linkTail(Slab* slab) {
+  slab->next = nullptr;
+  if (tail_) {
+    tail_->next = slab;
+  } else {
+    head_ = slab;
+  }
+  tail_ = slab;
+  ++numSlabs_;
+}
+
+void ChainBuffer::releaseAll() {
+  SlabPool& pool = SlabPool::instance();
+  while (head_) {
+    Slab* slab = head_;
+    head_ = slab->next;
+    pool.deallocate(slab);
+  }
+  tail_ = nullptr;
+  readable_ = 0;
+  numSlabs_ = 0;
+}
@@ -0,0 +1,318 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_CHAIN_BUFFER_H
+#define LIBEL_CHAIN_BUFFER_H
+
+#include "libel/base/noncopyable.h"
+#include "libel/net/Endian.h"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include <sys/types.h>
+
+// forward declaration
+// struct iovec is in <sys/uio.h>
+struct iovec;
+
+namespace Libel {
+
+namespace net {
+
+namespace detail {
+
+/// fixed-size memory block, the unit of ChainBuffer.
+///
+/// @code
+/// +-------------------+------------------+------------------+
+/// |   consumed bytes  |  readable bytes  |  writable bytes  |
+/// +-------------------+------------------+------------------+
+/// 0      <=      readIndex    <=    writeIndex   <=    kSlabSize
+/// @endcode
+struct Slab {
+  static const size_t kSlabSize = 16 * 1024;
+
+  size_t readableBytes() const { return writeIndex - readIndex; }
+  size_t writableBytes() const { return kSlabSize - writeIndex; }
+  char* peek() { return data + readIndex; }
+  const char* peek() const { return data + readIndex; }
+  char* beginWrite() { return data + writeIndex; }
+
+  Slab* next;
+  size_t readIndex;
+  size_t writeIndex;
+  char data[kSlabSize];
+};
+
+/// Per-thread free list of slabs.
+///
+/// Buffers belong to one IO thread most of the time, so a thread local
+/// free list gives us allocation without locking. A slab released in
+/// another thread simply goes to that thread's free list.
+class SlabPool : noncopyable {
+ public:
+  static const size_t kMaxCachedSlabs = 256;  // 4MB per thread
+
+  SlabPool() : freeList_(nullptr), numCached_(0) {}
+  ~SlabPool();
+
+  /// pool of current thread
+  static SlabPool& instance();
+
+  /// returned slab is empty, with readIndex == writeIndex == 0
+  Slab* allocate();
+  void deallocate(Slab* slab);
+
+  size_t cachedSlabs() const { return numCached_; }
+
+ private:
+  Slab* freeList_;
+  size_t numCached_;
+};
+
+}  // namespace detail
+
+/// A buffer made of a chain of fixed-size, pool-allocated slabs.
+///
+/// It keeps the peek/retrieve/append/prepend interface of Buffer, but
+/// appending never moves or reallocates bytes already in the buffer,
+/// new slabs are linked at the tail and retrieved slabs go back to the
+/// SlabPool. This makes it suitable for multi-megabytes payloads which
+/// make Buffer::makeSpace() copy everything again and again.
+///
+/// @code
+///   head                                                  tail
+/// +---------+------+    +-------------------+    +------+----------+
+/// | prepend | data | -> |        data       | -> | data | writable |
+/// +---------+------+    +-------------------+    +------+----------+
+/// @endcode
+///
+/// Readable bytes are only contiguous inside one slab, so peek() only
+/// exposes contiguousBytes() bytes, use pullup() if a flat view of a
+/// prefix is needed, or peekIovec() for writev.
+class ChainBuffer : noncopyable {
+ public:
+  static const size_t kCheapPrepend = 8;
+  static const size_t kSlabSize = detail::Slab::kSlabSize;
+  /// how many fresh slabs readFd() reads into at most
+  static const int kMaxReadSlabs = 4;
+
+  ChainBuffer() : head_(nullptr), tail_(nullptr), readable_(0), numSlabs_(0) {}
+  ~ChainBuffer() { releaseAll(); }
+
+  ChainBuffer(ChainBuffer&& rhs) noexcept;
+  ChainBuffer& operator=(ChainBuffer&& rhs) noexcept;
+
+  void swap(ChainBuffer& rhs);
+
+  size_t readableBytes() const { return readable_; }
+
+  size_t numSlabs() const { return numSlabs_; }
+
+  /// readable bytes in the first slab, which can be accessed by peek()
+  size_t contiguousBytes() const {
+    return head_ ? head_->readableBytes() : 0;
+  }
+
+  /// nullptr if the buffer is empty
+  const char* peek() const {
+    return readable_ > 0 ? head_->peek() : nullptr;
+  }
+
+  /// makes the first len bytes contiguous and returns them.
+  ///
+  /// Only the first len bytes are copied, at most once.
+  /// Require: len <= readableBytes() && len <= kSlabSize
+  const char* pullup(size_t len);
+
+  /// copies the first len bytes to dest without consuming them
+  /// Require: len <= readableBytes()
+  void copyOut(void* dest, size_t len) const;
+
+  void retrieve(size_t len);
+
+  void retrieveAll() {
+    releaseAll();
+  }
+
+  void retrieveInt64() { retrieve(sizeof(int64_t)); }
+  void retrieveInt32() { retrieve(sizeof(int32_t)); }
+  void retrieveInt16() { retrieve(sizeof(int16_t)); }
+  void retrieveInt8() { retrieve(sizeof(int8_t)); }
+
+  std::string retrieveAsString(size_t len) {
+    assert(len <= readableBytes());
+    std::string result(len, '\0');
+    copyOut(&*result.begin(), len);
+    retrieve(len);
+    return result;
+  }
+
+  std::string retrieveAllAsString() {
+    return retrieveAsString(readableBytes());
+  }
+
+  std::string toString() const {
+    std::string result(readable_, '\0');
+    copyOut(&*result.begin(), readable_);
+    return result;
+  }
+
+  void append(const char* data, size_t len);
+
+  void append(const void* data, size_t len) {
+    append(static_cast<const char*>(data), len);
+  }
+
+  void append(const std::string& str) {
+    append(str.data(), str.size());
+  }
+
+  ///
+  /// append int64_t using network endian
+  ///
+  void appendInt64(int64_t val) {
+    int64_t netEndianVal = sockets::hostToNetwork64(val);
+    append(&netEndianVal, sizeof(netEndianVal));
+  }
+
+  ///
+  /// append int32_t using network endian
+  ///
+  void appendInt32(int32_t val) {
+    int32_t netEndianVal = sockets::hostToNetwork32(val);
+    append(&netEndianVal, sizeof(netEndianVal));
+  }
+
+  ///
+  /// append int16_t using network endian
+  ///
+  void appendInt16(int16_t val) {
+    int16_t netEndianVal = sockets::hostToNetwork16(val);
+    append(&netEndianVal, sizeof(netEndianVal));
+  }
+
+  void appendInt8(int8_t val) {
+    append(&val, sizeof(val));
+  }
+
+  /// Unlike Buffer::prepend, there is no limit of len,
+  /// a new slab is linked before head if the head slab has no room.
+  void prepend(const void* data, size_t len);
+
+  ///
+  /// Prepend int64_t using network endian
+  ///
+  void prependInt64(int64_t x) {
+    int64_t be64 = sockets::hostToNetwork64(x);
+    prepend(&be64, sizeof be64);
+  }
+
+  ///
+  /// Prepend int32_t using network endian
+  ///
+  void prependInt32(int32_t x) {
+    int32_t be32 = sockets::hostToNetwork32(x);
+    prepend(&be32, sizeof be32);
+  }
+
+  ///
+  /// Prepend int16_t using network endian
+  ///
+  void prependInt16(int16_t x) {
+    int16_t be16 = sockets::hostToNetwork16(x);
+    prepend(&be16, sizeof be16);
+  }
+
+  void prependInt8(int8_t x) {
+    prepend(&x, sizeof x);
+  }
+
+  ///
+  /// Peek int64_t from network endian
+  ///
+  /// Require: buf->readableBytes() >= sizeof(int64_t)
+  int64_t peekInt64() const {
+    int64_t val = 0;
+    copyOut(&val, sizeof(val));
+    return sockets::networkToHost64(val);
+  }
+
+  ///
+  /// Peek int32_t from network endian
+  ///
+  /// Require: buf->readableBytes() >= sizeof(int32_t)
+  int32_t peekInt32() const {
+    int32_t val = 0;
+    copyOut(&val, sizeof(val));
+    return sockets::networkToHost32(val);
+  }
+
+  ///
+  /// Peek int16_t from network endian
+  ///
+  /// Require: buf->readableBytes() >= sizeof(int16_t)
+  int16_t peekInt16() const {
+    int16_t val = 0;
+    copyOut(&val, sizeof(val));
+    return sockets::networkToHost16(val);
+  }
+
+  int8_t peekInt8() const {
+    assert(readableBytes() >= sizeof(int8_t));
+    int8_t x = *peek();
+    return x;
+  }
+
+  int64_t readInt64() {
+    int64_t result = peekInt64();
+    retrieveInt64();
+    return result;
+  }
+
+  int32_t readInt32() {
+    int32_t result = peekInt32();
+    retrieveInt32();
+    return result;
+  }
+
+  int16_t readInt16() {
+    int16_t result = peekInt16();
+    retrieveInt16();
+    return result;
+  }
+
+  int8_t readInt8() {
+    int8_t result = peekInt8();
+    retrieveInt8();
+    return result;
+  }
+
+  /// fills iov with readable slabs, for writev.
+  /// returns number of iovec filled, at most maxIov.
+  int peekIovec(struct iovec* iov, int maxIov) const;
+
+  /// Read data directly into slabs with readv, the writable space of
+  /// tail slab and at most kMaxReadSlabs fresh slabs are used.
+  ssize_t readFd(int fd, int* savedErrno);
+
+  /// Write readable slabs with one writev, and retrieve written bytes.
+  ssize_t writeFd(int fd, int* savedErrno);
+
+ private:
+  void linkTail(detail::Slab* slab);
+  void releaseAll();
+
+  detail::Slab* head_;
+  detail::Slab* tail_;
+  size_t readable_;
+  size_t numSlabs_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_CHAIN_BUFFER_H
@@ -8,10 +8,13 @@
 
 #include <cassert>
 #include <sstream>
+#include <sys/epoll.h>
 
 using namespace Libel;
 using namespace Libel::net;
 
+const int Channel::kEdgeTriggered = static_cast<int>(EPOLLET);
+
 Channel::Channel(Libel::net::EventLoop *loop, int fd)
     : loop_(loop),
       fd_(fd),
@@ -19,6 +22,8 @@ Channel::Channel(Libel::net::EventLoop *loop, int fd)
       revents_(0),
       index_(-1),
       logHup_(true),
+      edgeTriggered_(false),
+      registeredEvents_(kNoneEvent),
       tied_(false),
       eventHandling_(false),
       addedToLoop_(false) {}
@@ -36,8 +41,20 @@ void Channel::tie(const std::shared_ptr<void> &obj) {
   tied_ = true;
 }
 
+void Channel::setEdgeTriggered(bool on) {
+  assert(!addedToLoop_);
+  assert(!on || loop_->supportsEdgeTriggered());
+  edgeTriggered_ = on;
+}
+
 void Channel::update() {
   addedToLoop_ = true;
+  if (edgeTriggered_) {
+    /// toggling write interest changes nothing registered
+    const int events = pollEvents();
+    if (index_ != -1 && events == registeredEvents_) return;
+    registeredEvents_ = events;
+  }
   loop_->updateChannel(this);
 }
 
@@ -116,6 +133,8 @@ std::string Channel::events2String(int fd, int ev) {
         oss << "ERR ";
     if (ev & POLLNVAL)
         oss << "NVAL ";
+    if (ev & kEdgeTriggered)
+        oss << "ET ";
     return oss.str();
 }
 
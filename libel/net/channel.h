@@ -49,8 +49,14 @@ public:
 
     int fd() const { return fd_; }
     int events() const { return events_; }
+    int revents() const { return revents_; }
     void set_revent(int revent) { revents_ = revent; } /// used by poller
     bool isNoneEvent() const { return events_ == kNoneEvent; }
+    /// events to be registered to the poller, see setEdgeTriggered()
+    int pollEvents() const {
+        if (!edgeTriggered_ || events_ == kNoneEvent) return events_;
+        return (events_ & kReadEvent) | kWriteEvent | kEdgeTriggered;
+    }
 
     void enableReading() { events_  |= kReadEvent; update(); }
     void disableReading() { events_  &= ~kReadEvent; update(); }
@@ -65,6 +71,17 @@ public:
 
     void doNotLogHup() { logHup_ = false; }
 
+    /// Registers with EPOLLET, only for loops whose
+    /// EventLoop::supportsEdgeTriggered(), before the channel is enabled.
+    ///
+    /// Write interest stays registered as long as any event is enabled,
+    /// so enableWriting() and disableWriting() only flip isWriting(),
+    /// without epoll_ctl. Readiness is reported once per change, the
+    /// handlers must read or write until EAGAIN, or come back later
+    /// by themselves.
+    void setEdgeTriggered(bool on);
+    bool edgeTriggered() const { return edgeTriggered_; }
+
     EventLoop* ownerLoop() { return loop_; }
 
     void removeSelfFromLoop();
@@ -80,6 +97,7 @@ private:
     static const int kNoneEvent= 0;
     static const int kReadEvent = POLLIN | POLLPRI;
     static const int kWriteEvent = POLLOUT;
+    static const int kEdgeTriggered;
 
     EventLoop* loop_;
     const int fd_;
@@ -90,6 +108,8 @@ private:
     // >= 0 means the index of the channel in Poller
     int index_;
     bool logHup_; // whether to log warning message when received POLLHUP event
+    bool edgeTriggered_;
+    int registeredEvents_; // last pollEvents() passed to poller, edge triggered only
 
     std::weak_ptr<void> tie_;
     bool tied_;
@@ -0,0 +1,94 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_CHANNEL_TABLE_H
+#define LIBEL_CHANNEL_TABLE_H
+
+#include "libel/base/noncopyable.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace Libel {
+
+namespace net {
+
+class Channel;
+
+///
+/// Channels of a Poller, indexed by fd.
+///
+/// fds are small and dense, so a vector growing with the largest fd
+/// beats a tree in both lookups and cache misses. Each slot counts
+/// the channels registered on it, so an event tagged with the
+/// generation it was registered with can be told from one for an fd
+/// closed and reused since.
+///
+class ChannelTable : noncopyable {
+ public:
+  ChannelTable() : size_(0) {}
+
+  /// nullptr if none
+  Channel* find(int fd) const {
+    const size_t index = static_cast<size_t>(fd);
+    return index < slots_.size() ? slots_[index].channel : nullptr;
+  }
+
+  bool contains(int fd, const Channel* channel) const {
+    return find(fd) == channel;
+  }
+
+  /// the channel of fd if it is still the one of generation, else nullptr
+  Channel* find(int fd, uint32_t generation) const {
+    const size_t index = static_cast<size_t>(fd);
+    if (index >= slots_.size() || slots_[index].generation != generation) {
+      return nullptr;
+    }
+    return slots_[index].channel;
+  }
+
+  /// generation of the channel currently on fd
+  uint32_t generation(int fd) const {
+    assert(find(fd) != nullptr);
+    return slots_[static_cast<size_t>(fd)].generation;
+  }
+
+  void add(int fd, Channel* channel) {
+    assert(fd >= 0);
+    const size_t index = static_cast<size_t>(fd);
+    if (index >= slots_.size()) {
+      slots_.resize(index + 1);
+    }
+    Slot& slot = slots_[index];
+    assert(slot.channel == nullptr);
+    slot.channel = channel;
+    ++slot.generation;
+    ++size_;
+  }
+
+  void remove(int fd, const Channel* channel) {
+    assert(contains(fd, channel));
+    (void)channel;
+    slots_[static_cast<size_t>(fd)].channel = nullptr;
+    --size_;
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  struct Slot {
+    Slot() : channel(nullptr), generation(0) {}
+    Channel* channel;
+    uint32_t generation;
+  };
+
+  std::vector<Slot> slots_;
+  size_t size_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_CHANNEL_TABLE_H
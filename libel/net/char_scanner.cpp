@@ -0,0 +1,195 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/char_scanner.h"
+
+#include <cassert>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIBEL_SCANNER_X86 1
+#endif
+
+using namespace Libel;
+using namespace Libel::net;
+
+namespace {
+
+const char* findCRLFScalar(const char* begin, const char* end) {
+  const char* p = begin;
+  while (end - p >= 2) {
+    const char* cr = static_cast<const char*>(
+        memchr(p, '\r', static_cast<size_t>(end - p - 1)));
+    if (!cr) break;
+    if (cr[1] == '\n') return cr;
+    p = cr + 1;
+  }
+  return nullptr;
+}
+
+const char* findFirstOfScalar(const char* begin, const char* end,
+                              const char* ranges, int numRanges) {
+  for (const char* p = begin; p < end; ++p) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    for (int i = 0; i < numRanges; ++i) {
+      if (static_cast<unsigned char>(ranges[2 * i]) <= c &&
+          c <= static_cast<unsigned char>(ranges[2 * i + 1])) {
+        return p;
+      }
+    }
+  }
+  return nullptr;
+}
+
+#ifdef LIBEL_SCANNER_X86
+
+/// '\r' at p[i] and '\n' at p[i + 1], by comparing two overlapping loads
+__attribute__((target("sse2")))
+const char* findCRLFSse(const char* begin, const char* end) {
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const char* p = begin;
+  while (end - p >= 17) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    const int mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, cr), _mm_cmpeq_epi8(b, lf)));
+    if (mask != 0) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    p += 16;
+  }
+  return findCRLFScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+int crlfMaskAvx2(const char* p) {
+  const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i b =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+  return _mm256_movemask_epi8(
+      _mm256_and_si256(_mm256_cmpeq_epi8(a, _mm256_set1_epi8('\r')),
+                       _mm256_cmpeq_epi8(b, _mm256_set1_epi8('\n'))));
+}
+
+/// 64 bytes per round looking for '\r' only, CRLF is checked on hits,
+/// so long lines cost one compare per 32 bytes
+__attribute__((target("avx2")))
+const char* findCRLFAvx2(const char* begin, const char* end) {
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const char* p = begin;
+  while (end - p >= 65) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    if (!_mm256_testz_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(a, cr), _mm256_cmpeq_epi8(b, cr)),
+            _mm256_set1_epi8(-1))) {
+      int mask = crlfMaskAvx2(p);
+      if (mask != 0) return p + __builtin_ctz(static_cast<unsigned>(mask));
+      mask = crlfMaskAvx2(p + 32);
+      if (mask != 0) return p + 32 + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    p += 64;
+  }
+  while (end - p >= 33) {
+    const int mask = crlfMaskAvx2(p);
+    if (mask != 0) return p + __builtin_ctz(static_cast<unsigned>(mask));
+    p += 32;
+  }
+  return findCRLFSse(p, end);
+}
+
+/// pcmpestri in ranges mode checks 16 bytes against all ranges at once
+__attribute__((target("sse4.2")))
+const char* findFirstOfSse42(const char* begin, const char* end,
+                             const char* ranges, int numRanges) {
+  assert(0 < numRanges && numRanges <= 8);
+  char padded[16] = {};
+  memcpy(padded, ranges, static_cast<size_t>(2 * numRanges));
+  const __m128i set = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded));
+  const int setLen = 2 * numRanges;
+  const char* p = begin;
+  while (end - p >= 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int index = _mm_cmpestri(
+        set, setLen, bytes, 16,
+        _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16) return p + index;
+    p += 16;
+  }
+  return findFirstOfScalar(p, end, ranges, numRanges);
+}
+
+#endif  // LIBEL_SCANNER_X86
+
+/// -1 until resolved
+std::atomic<int> g_isa(-1);
+
+}  // namespace
+
+std::atomic<CharScanner::FindCRLF> CharScanner::s_findCRLF(
+    &CharScanner::resolveFindCRLF);
+std::atomic<CharScanner::FindFirstOf> CharScanner::s_findFirstOf(
+    &CharScanner::resolveFindFirstOf);
+
+CharScanner::Isa CharScanner::supportedIsa() {
+#ifdef LIBEL_SCANNER_X86
+  /// may run before constructors of libgcc
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return kAvx2;
+  if (__builtin_cpu_supports("sse4.2")) return kSse42;
+#endif
+  return kScalar;
+}
+
+CharScanner::Isa CharScanner::isa() {
+  int isa = g_isa.load(std::memory_order_relaxed);
+  if (isa < 0) {
+    setIsa(supportedIsa());
+    isa = g_isa.load(std::memory_order_relaxed);
+  }
+  return static_cast<Isa>(isa);
+}
+
+void CharScanner::setIsa(Isa isa) {
+  assert(isa <= supportedIsa());
+  FindCRLF findCRLF = findCRLFScalar;
+  FindFirstOf findFirstOf = findFirstOfScalar;
+#ifdef LIBEL_SCANNER_X86
+  if (isa == kAvx2) {
+    findCRLF = findCRLFAvx2;
+    /// pcmpestri has no wider form
+    findFirstOf = findFirstOfSse42;
+  } else if (isa == kSse42) {
+    findCRLF = findCRLFSse;
+    findFirstOf = findFirstOfSse42;
+  }
+#endif
+  s_findCRLF.store(findCRLF, std::memory_order_relaxed);
+  s_findFirstOf.store(findFirstOf, std::memory_order_relaxed);
+  g_isa.store(isa, std::memory_order_relaxed);
+}
+
+const char* CharScanner::isaName(Isa isa) {
+  switch (isa) {
+    case kAvx2:
+      return "avx2";
+    case kSse42:
+      return "sse4.2";
+    default:
+      return "scalar";
+  }
+}
+
+const char* CharScanner::resolveFindCRLF(const char* begin,
+                                         const char* end) {
+  isa();
+  return findCRLF(begin, end);
+}
+
+const char* CharScanner::resolveFindFirstOf(const char* begin, const char* end,
+                                            const char* ranges,
+                                            int numRanges) {
+  isa();
+  return findFirstOf(begin, end, ranges, numRanges);
+}
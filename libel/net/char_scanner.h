@@ -0,0 +1,75 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_CHAR_SCANNER_H
+#define LIBEL_CHAR_SCANNER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace Libel {
+
+namespace net {
+
+///
+/// Finds delimiters of line protocols many bytes at a time, like
+/// picohttpparser does. The widest instruction set supported by the CPU
+/// is picked at runtime, on first use, so binaries built for generic
+/// x86-64 still use AVX2. Other CPUs get the scalar code.
+///
+/// Used by Buffer::findCRLF() and HttpContext.
+class CharScanner {
+ public:
+  enum Isa { kScalar, kSse42, kAvx2 };
+
+  /// the widest supported by this CPU
+  static Isa supportedIsa();
+  /// the one in use
+  static Isa isa();
+  /// For tests and benchmarks, not thread safe.
+  /// isa must not be wider than supportedIsa().
+  static void setIsa(Isa isa);
+  static const char* isaName(Isa isa);
+
+  /// first "\r\n" in [begin, end), nullptr if none
+  static const char* findCRLF(const char* begin, const char* end) {
+    return s_findCRLF.load(std::memory_order_relaxed)(begin, end);
+  }
+
+  /// first c in [begin, end), nullptr if none.
+  /// memchr(3) of glibc is vectorized already.
+  static const char* findChar(const char* begin, const char* end, char c) {
+    return static_cast<const char*>(
+        memchr(begin, c, static_cast<size_t>(end - begin)));
+  }
+
+  /// First byte in [begin, end) falling into one of the inclusive ranges,
+  /// given as pairs of bytes, e.g. "  ??" for ' ' or '?', nullptr if none.
+  /// At most 8 ranges, numRanges counts pairs.
+  static const char* findFirstOf(const char* begin, const char* end,
+                                 const char* ranges, int numRanges) {
+    return s_findFirstOf.load(std::memory_order_relaxed)(begin, end, ranges,
+                                                         numRanges);
+  }
+
+ private:
+  using FindCRLF = const char* (*)(const char*, const char*);
+  using FindFirstOf = const char* (*)(const char*, const char*, const char*,
+                                      int);
+
+  /// both start as resolvers, which pick the implementation and call it,
+  /// so they are ready before any dynamic initialization
+  static std::atomic<FindCRLF> s_findCRLF;
+  static std::atomic<FindFirstOf> s_findFirstOf;
+
+  static const char* resolveFindCRLF(const char* begin, const char* end);
+  static const char* resolveFindFirstOf(const char* begin, const char* end,
+                                        const char* ranges, int numRanges);
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_CHAR_SCANNER_H
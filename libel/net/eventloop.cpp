@@ -3,12 +3,13 @@
 //
 
 #include "libel/net/eventloop.h"
-#include "libel/base/Mutex.h"
+#include "libel/base/counter.h"
 #include "libel/base/logging.h"
 #include "libel/net/channel.h"
 #include "libel/net/poller.h"
 #include "libel/net/sockets_ops.h"
-#include "libel/net/timerqueue.h"
+#include "libel/net/timer_scheduler.h"
+#include "libel/net/timing_wheel.h"
 
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -23,6 +24,14 @@ __thread EventLoop* t_loopInThisThread = nullptr;
 
 const int kPollTimeMs = 10000;
 
+/// counters have a single writer, the loop thread
+using Util::add;
+using Util::raise;
+
+inline int64_t nowMicroSeconds() {
+  return TimeStamp::now().microSecondsSinceEpoch();
+}
+
 int createEventfd() {
   int efd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
   if (efd < 0) {
@@ -33,6 +42,89 @@ int createEventfd() {
 
 }  // namespace
 
+/// Nodes are recycled instead of going back to malloc.
+///
+/// Loop threads push consumed nodes onto a global lock-free stack, a
+/// producer whose thread local cache runs dry takes the whole stack at
+/// once. Pushing with CAS and taking all with exchange are both free
+/// of ABA problem, unlike popping one node from a shared stack.
+struct EventLoop::PendingFunctor : MpscNode {
+  /// nodes parked in the global stack and thread local caches
+  static const size_t kMaxFreeNodes = 4096;
+
+  static PendingFunctor* create(Functor cb) {
+    PendingFunctor* node = LocalCache::instance().take();
+    if (!node) {
+      node = new PendingFunctor;
+    }
+    node->functor = std::move(cb);
+    node->queuedAt = nowMicroSeconds();
+    return node;
+  }
+
+  /// called in loop thread after the functor has run
+  static void recycle(PendingFunctor* node) {
+    /// captures are released in loop thread, as before
+    node->functor = nullptr;
+    if (s_numFreeNodes.load(std::memory_order_relaxed) >= kMaxFreeNodes) {
+      delete node;
+      return;
+    }
+    s_numFreeNodes.fetch_add(1, std::memory_order_relaxed);
+    MpscNode* head = s_freeNodes.load(std::memory_order_relaxed);
+    do {
+      node->next.store(head, std::memory_order_relaxed);
+    } while (!s_freeNodes.compare_exchange_weak(head, node,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+  }
+
+  Functor functor;
+  /// for Metrics::functorDelayMicroSeconds
+  int64_t queuedAt;
+
+ private:
+  struct LocalCache {
+    LocalCache() : head(nullptr) {}
+    ~LocalCache() {
+      while (head) {
+        PendingFunctor* node = head;
+        head = static_cast<PendingFunctor*>(node->next.load());
+        /// still counted as free, or recycling stops for good
+        s_numFreeNodes.fetch_sub(1, std::memory_order_relaxed);
+        delete node;
+      }
+    }
+
+    static LocalCache& instance() {
+      static thread_local LocalCache cache;
+      return cache;
+    }
+
+    PendingFunctor* take() {
+      if (!head) {
+        head = static_cast<PendingFunctor*>(
+            s_freeNodes.exchange(nullptr, std::memory_order_acquire));
+        if (!head) return nullptr;
+      }
+      PendingFunctor* node = head;
+      head = static_cast<PendingFunctor*>(
+          node->next.load(std::memory_order_relaxed));
+      s_numFreeNodes.fetch_sub(1, std::memory_order_relaxed);
+      return node;
+    }
+
+    PendingFunctor* head;
+  };
+
+  static std::atomic<MpscNode*> s_freeNodes;
+  static std::atomic<size_t> s_numFreeNodes;
+};
+
+std::atomic<MpscNode*> EventLoop::PendingFunctor::s_freeNodes(nullptr);
+std::atomic<size_t> EventLoop::PendingFunctor::s_numFreeNodes(0);
+const size_t EventLoop::PendingFunctor::kMaxFreeNodes;
+
 EventLoop* EventLoop::getEventLoopOfCurrentThead() {
   return t_loopInThisThread;
 }
@@ -44,12 +136,29 @@ EventLoop::EventLoop()
       callingPendingFunctors_(false),
       iteration_(0),
       threadId_(CurrentThread::tid()),
+      spinMicroSeconds_(0),
+      numSpinPolls_(0),
+      numSpinHits_(0),
+      numBlockingWaits_(0),
+      pollWaitMicroSeconds_(0),
+      numActiveChannels_(0),
+      maxActiveChannels_(0),
+      handlerMicroSeconds_(0),
+      maxHandlerMicroSeconds_(0),
+      numFunctors_(0),
+      functorMicroSeconds_(0),
+      functorDelayMicroSeconds_(0),
+      maxFunctorDelayMicroSeconds_(0),
+      maxQueueSize_(0),
+      numSlowCallbacks_(0),
+      slowCallbackMicroSeconds_(0),
       poller_(Poller::newDefaultPoller(this)),
-      timerQueue_(new TimerQueue(this)),
+      timerQueue_(TimerScheduler::newDefaultTimerScheduler(this)),
       wakeupFd_(createEventfd()),
       wakeupChannel_(new Channel(this, wakeupFd_)),
       context_(nullptr),
-      currentActiveChannel_(nullptr) {
+      currentActiveChannel_(nullptr),
+      wakeupPending_(false) {
   LOG_DEBUG << "EventLoop created " << this << " in thread " << threadId_;
   if (t_loopInThisThread) {
     LOG_FATAL << "another EventLoop " << t_loopInThisThread
@@ -64,10 +173,17 @@ EventLoop::EventLoop()
 EventLoop::~EventLoop() {
   LOG_DEBUG << "Eventloop " << this << " of thread " << threadId_
             << " destructs in thread " << CurrentThread::tid();
+  {
+    /// a quit() of another thread may still be waking us up
+    MutexLockGuard lock(quitMutex_);
+  }
   wakeupChannel_->disableAll();
   wakeupChannel_->removeSelfFromLoop();
   ::close(wakeupFd_);
   t_loopInThisThread = nullptr;
+  while (PendingFunctor* pending = pendingFunctors_.pop()) {
+    delete pending;
+  }
 }
 
 void EventLoop::loop() {
@@ -79,34 +195,68 @@ void EventLoop::loop() {
     return;
   }
   LOG_TRACE << "Eventloop " << this << " start looping";
+  /// one clock read per callback, each one ends where the next starts
+  int64_t now = nowMicroSeconds();
   while (!quit_) {
     activeChannels_.clear();
-    pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
-    ++iteration_;
+    const bool spinning =
+        spinMicroSeconds_ > 0 &&
+        pollReturnTime_.microSecondsSinceEpoch() -
+                lastActiveTime_.microSecondsSinceEpoch() <
+            spinMicroSeconds_;
+    pollReturnTime_ =
+        poller_->poll(spinning ? 0 : kPollTimeMs, &activeChannels_);
+    add(iteration_, 1);
+    if (spinning) {
+      add(numSpinPolls_, 1);
+      if (!activeChannels_.empty()) {
+        add(numSpinHits_, 1);
+      }
+    } else {
+      add(numBlockingWaits_, 1);
+    }
+    const int64_t numActive = static_cast<int64_t>(activeChannels_.size());
+    add(numActiveChannels_, numActive);
+    raise(maxActiveChannels_, numActive);
+    add(pollWaitMicroSeconds_, pollReturnTime_.microSecondsSinceEpoch() - now);
+    now = pollReturnTime_.microSecondsSinceEpoch();
+    /// wakeupChannel_ and timers are channels too
+    if (!activeChannels_.empty()) {
+      lastActiveTime_ = pollReturnTime_;
+    }
     if (Logger::getLogLevel() <= Logger::TRACE) {
       printActiveChannels();
     }
     eventHandling_ = true;
     for (Channel* channel : activeChannels_) {
       currentActiveChannel_ = channel;
+      /// channel may be gone when handleEvent() returns
+      const int fd = channel->fd();
+      const int revents = channel->revents();
       currentActiveChannel_->handleEvent(pollReturnTime_);
+      const int64_t start = now;
+      now = endCallback(start, fd, revents);
+      add(handlerMicroSeconds_, now - start);
+      raise(maxHandlerMicroSeconds_, now - start);
     }
     currentActiveChannel_ = nullptr;
     eventHandling_ = false;
-    doPendingFunctors();
+    now = doPendingFunctors(now);
   }
   LOG_TRACE << "Eventloop " << this << " stop looping";
   looping_ = false;
 }
 
 void EventLoop::quit() {
+  if (isInLoopThread()) {
+    quit_ = true;
+    return;
+  }
+  /// loop() may see quit_ and the loop destruct before wakeup(),
+  /// ~EventLoop takes quitMutex_ first, so it waits for us
+  MutexLockGuard lock(quitMutex_);
   quit_ = true;
-  /// there is a chance that loop() just executes while(!quit_) and exits,
-  /// then Eventloop destructs, then we are accessing an invalid object.
-
-  //    if (!isInLoopThread()) {
-  //        wakeup();
-  //    }
+  wakeup();
 }
 
 void EventLoop::runInLoop(Functor cb) {
@@ -118,15 +268,15 @@ void EventLoop::runInLoop(Functor cb) {
 }
 
 void EventLoop::queueInLoop(Functor cb) {
-  {
-    MutexLockGuard lock(mutex_);
-    pendingFunctors_.push_back(std::move(cb));
+  pendingFunctors_.push(PendingFunctor::create(std::move(cb)));
+  /// only the first producer after doPendingFunctors() writes wakeupFd_
+  if ((!isInLoopThread() || callingPendingFunctors_) &&
+      !wakeupPending_.exchange(true)) {
+    wakeup();
   }
-  if (!isInLoopThread() || callingPendingFunctors_) wakeup();
 }
 
 size_t EventLoop::queueSize() const {
-  MutexLockGuard lock(mutex_);
   return pendingFunctors_.size();
 }
 
@@ -146,6 +296,76 @@ TimerId EventLoop::runEvery(double intervalSeconds, TimerCallback cb) {
 
 void EventLoop::cancel(const TimerId& timerId) { timerQueue_->cancel(timerId); }
 
+void EventLoop::setBusyPoll(int spinMicroSeconds) {
+  assertInLoopThread();
+  assert(spinMicroSeconds >= 0);
+  spinMicroSeconds_ = spinMicroSeconds;
+}
+
+EventLoop::Metrics EventLoop::metrics() const {
+  Metrics m;
+  m.iterations = iteration_.load(std::memory_order_relaxed);
+  m.pollWaitMicroSeconds =
+      pollWaitMicroSeconds_.load(std::memory_order_relaxed);
+  m.activeChannels = numActiveChannels_.load(std::memory_order_relaxed);
+  m.maxActiveChannels = maxActiveChannels_.load(std::memory_order_relaxed);
+  m.handlerMicroSeconds = handlerMicroSeconds_.load(std::memory_order_relaxed);
+  m.maxHandlerMicroSeconds =
+      maxHandlerMicroSeconds_.load(std::memory_order_relaxed);
+  m.functors = numFunctors_.load(std::memory_order_relaxed);
+  m.functorMicroSeconds = functorMicroSeconds_.load(std::memory_order_relaxed);
+  m.functorDelayMicroSeconds =
+      functorDelayMicroSeconds_.load(std::memory_order_relaxed);
+  m.maxFunctorDelayMicroSeconds =
+      maxFunctorDelayMicroSeconds_.load(std::memory_order_relaxed);
+  m.maxQueueSize = maxQueueSize_.load(std::memory_order_relaxed);
+  m.slowCallbacks = numSlowCallbacks_.load(std::memory_order_relaxed);
+  m.pollerSyscalls = poller_->syscalls();
+  return m;
+}
+
+void EventLoop::setSlowCallbackThreshold(double seconds) {
+  assert(seconds >= 0);
+  slowCallbackMicroSeconds_.store(
+      static_cast<int64_t>(seconds * TimeStamp::kMicroSecondsPerSecond),
+      std::memory_order_relaxed);
+}
+
+int64_t EventLoop::endCallback(int64_t start, int fd, int revents) {
+  const int64_t now = nowMicroSeconds();
+  const int64_t threshold =
+      slowCallbackMicroSeconds_.load(std::memory_order_relaxed);
+  if (threshold > 0 && now - start > threshold) {
+    add(numSlowCallbacks_, 1);
+    if (fd >= 0) {
+      LOG_WARN << "EventLoop " << this << " slow callback "
+               << Channel::events2String(fd, revents) << " took "
+               << now - start << " us";
+    } else {
+      LOG_WARN << "EventLoop " << this << " slow functor took "
+               << now - start << " us";
+    }
+  }
+  return now;
+}
+
+EventLoop::BusyPollStats EventLoop::busyPollStats() const {
+  BusyPollStats stats;
+  stats.spinPolls = numSpinPolls_.load(std::memory_order_relaxed);
+  stats.spinHits = numSpinHits_.load(std::memory_order_relaxed);
+  stats.blockingWaits = numBlockingWaits_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void EventLoop::useTimingWheel(double tickSeconds) {
+  assertInLoopThread();
+  /// once looping, other threads may have queued work bound to the old
+  /// scheduler, e.g. addTimerInLoop() of runAfter()
+  assert(!looping_);
+  assert(timerQueue_->size() == 0);
+  timerQueue_.reset(new TimingWheel(this, tickSeconds));
+}
+
 void EventLoop::updateChannel(Channel* channel) {
   assert(channel->ownerLoop() == this);
   assertInLoopThread();
@@ -169,6 +389,10 @@ bool EventLoop::hasChannel(Channel* channel) {
   return poller_->hasChannel(channel);
 }
 
+bool EventLoop::supportsEdgeTriggered() const {
+  return poller_->supportsEdgeTriggered();
+}
+
 void EventLoop::abortNotInLoopThread() {
   LOG_FATAL << "Eventloop::abortNotInLoopThead - eventloop" << this
             << " was created in threadId_ = " << threadId_
@@ -189,18 +413,31 @@ void EventLoop::handleRead() {
     LOG_ERROR << "Eventloop::handleRead() reads " << n << " bytes instead of 8";
 }
 
-void EventLoop::doPendingFunctors() {
-  std::vector<Functor> functors;
+int64_t EventLoop::doPendingFunctors(int64_t now) {
   callingPendingFunctors_ = true;
+  /// must be cleared before draining, a producer pushing after this
+  /// point will wake us up again if we miss its functor.
+  wakeupPending_ = false;
 
-  {
-    MutexLockGuard lock(mutex_);
-    functors.swap(pendingFunctors_);
-  }
-  for (const auto& functor : functors) {
-    functor();
+  /// functors queued by functors run in next iteration, as before
+  size_t n = pendingFunctors_.size();
+  raise(maxQueueSize_, static_cast<int64_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    PendingFunctor* pending = pendingFunctors_.pop();
+    if (!pending) break;  // a producer is in the middle of push
+    /// may be queued after now was taken
+    const int64_t delay = std::max<int64_t>(0, now - pending->queuedAt);
+    add(functorDelayMicroSeconds_, delay);
+    raise(maxFunctorDelayMicroSeconds_, delay);
+    pending->functor();
+    PendingFunctor::recycle(pending);
+    const int64_t start = now;
+    now = endCallback(start, -1, 0);
+    add(functorMicroSeconds_, now - start);
+    add(numFunctors_, 1);
   }
   callingPendingFunctors_ = false;
+  return now;
 }
 
 void EventLoop::printActiveChannels() const {
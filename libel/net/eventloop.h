@@ -11,6 +11,8 @@
 
 #include "libel/base/Mutex.h"
 #include "libel/base/current_thread.h"
+#include "libel/base/inplace_task.h"
+#include "libel/base/mpsc_queue.h"
 #include "libel/base/timestamp.h"
 #include "libel/net/callbacks.h"
 #include "libel/net/timerId.h"
@@ -21,12 +23,13 @@ namespace net {
 
 class Channel;
 class Poller;
-class TimerQueue;
+class TimerScheduler;
 
 /// Reactor, at most one per thread
 class EventLoop : noncopyable {
  public:
-  using Functor = std::function<void()>;
+  /// move-only, small functors are stored without heap allocation
+  using Functor = InplaceTask;
   using ChannelList = std::vector<Channel *>;
 
   EventLoop();
@@ -36,21 +39,71 @@ class EventLoop : noncopyable {
   /// should be called in the same thread as creation of the loop
   void loop();
 
-  /// quits loop
-  ///
+  /// quits loop, thread safe.
+  /// From other threads the loop is woken up, so it quits right away
+  /// instead of after its current poll.
   void quit();
 
   /// time when poller returns, usually means data arrival
   TimeStamp pollReturnTime() const { return pollReturnTime_; }
 
-  int64_t iteration() const { return iteration_; }
+  int64_t iteration() const {
+    return iteration_.load(std::memory_order_relaxed);
+  }
+
+  /// Counters since the loop started, readable from any thread without
+  /// locking, each field is exact but they are not a consistent snapshot.
+  /// Sample twice and subtract to get rates.
+  struct Metrics {
+    int64_t iterations;
+    int64_t pollWaitMicroSeconds;  // in Poller::poll, idle or blocked
+    int64_t activeChannels;        // summed over iterations
+    int64_t maxActiveChannels;     // most in one iteration
+    int64_t handlerMicroSeconds;   // in Channel::handleEvent
+    int64_t maxHandlerMicroSeconds;
+    int64_t functors;              // functors run
+    int64_t functorMicroSeconds;   // running functors
+    /// from queueInLoop() to the functor starting to run, the loop lag
+    int64_t functorDelayMicroSeconds;
+    int64_t maxFunctorDelayMicroSeconds;
+    int64_t maxQueueSize;          // pending functors found at once
+    int64_t slowCallbacks;         // see setSlowCallbackThreshold()
+    int64_t pollerSyscalls;        // see Poller::syscalls()
+  };
+  Metrics metrics() const;
+
+  /// Logs a warning for each Channel::handleEvent() or functor taking
+  /// longer than seconds, and counts it in Metrics::slowCallbacks.
+  /// 0 disables it, the default. Thread safe.
+  void setSlowCallbackThreshold(double seconds);
+
+  /// counters of busy polling, readable from any thread
+  struct BusyPollStats {
+    int64_t spinPolls;      // polls with zero timeout
+    int64_t spinHits;       // zero timeout polls which found events
+    int64_t blockingWaits;  // polls which may block
+  };
+
+  ///
+  /// Busy polling for latency critical loops.
+  /// After an iteration with any active channel, the loop keeps polling
+  /// with zero timeout for spinMicroSeconds before blocking again, so
+  /// data arriving in the meantime is picked up without going through
+  /// the scheduler. Burns a core while spinning, 0 disables it, the default.
+  /// Must be called in loop thread, e.g. in the ThreadInitCallback.
+  /// See also TcpServer::setSocketBusyPoll().
+  ///
+  void setBusyPoll(int spinMicroSeconds);
+  int busyPoll() const { return spinMicroSeconds_; }
+  BusyPollStats busyPollStats() const;
 
   /// thread safe
   void runInLoop(Functor cb);
 
-  /// thread safe
+  /// thread safe, lock free
   void queueInLoop(Functor cb);
 
+  /// approximate number of pending functors
   size_t queueSize() const;
 
   // timers
@@ -76,11 +129,22 @@ class EventLoop : noncopyable {
   ///
   void cancel(const TimerId &timerId);
 
+  ///
+  /// Replaces the timer backend with a hierarchical TimingWheel,
+  /// O(1) to add or cancel a timer, at the cost of tickSeconds resolution.
+  /// Must be called in loop thread before loop() and before any timer
+  /// is added, e.g. in the ThreadInitCallback of EventLoopThread, which
+  /// runs before other threads get the loop.
+  ///
+  void useTimingWheel(double tickSeconds = 0.001);
+
   void wakeup();
 
   void updateChannel(Channel *channel);
   void removeChannel(Channel *channel);
   bool hasChannel(Channel *channel);
+  /// whether channels may Channel::setEdgeTriggered(), epoll only
+  bool supportsEdgeTriggered() const;
 
   void assertInLoopThread() {
     if (!isInLoopThread()) {
@@ -96,21 +160,49 @@ class EventLoop : noncopyable {
   static EventLoop *getEventLoopOfCurrentThead();
 
  private:
+  /// node of pendingFunctors_
+  struct PendingFunctor;
+
   void abortNotInLoopThread();
   void handleRead();  // for wakeup
-  void doPendingFunctors();
+  /// now is when the previous callback returned, returns the same
+  int64_t doPendingFunctors(int64_t now);
+  /// how a callback started at start went, returns when it returned
+  int64_t endCallback(int64_t start, int fd, int revents);
 
   void printActiveChannels() const;  // just for debug
 
   std::atomic<bool> looping_;
   std::atomic<bool> quit_;
+  /// held by quit() of other threads while it touches the loop, so that
+  /// ~EventLoop waits for it
+  MutexLock quitMutex_;
   std::atomic<bool> eventHandling_;
   std::atomic<bool> callingPendingFunctors_;
-  int64_t iteration_;
+  std::atomic<int64_t> iteration_;
   const pid_t threadId_;
   TimeStamp pollReturnTime_;
+  int spinMicroSeconds_;
+  /// pollReturnTime_ of the last iteration with anything to do
+  TimeStamp lastActiveTime_;
+  std::atomic<int64_t> numSpinPolls_;
+  std::atomic<int64_t> numSpinHits_;
+  std::atomic<int64_t> numBlockingWaits_;
+  /// metrics, written by loop thread only
+  std::atomic<int64_t> pollWaitMicroSeconds_;
+  std::atomic<int64_t> numActiveChannels_;
+  std::atomic<int64_t> maxActiveChannels_;
+  std::atomic<int64_t> handlerMicroSeconds_;
+  std::atomic<int64_t> maxHandlerMicroSeconds_;
+  std::atomic<int64_t> numFunctors_;
+  std::atomic<int64_t> functorMicroSeconds_;
+  std::atomic<int64_t> functorDelayMicroSeconds_;
+  std::atomic<int64_t> maxFunctorDelayMicroSeconds_;
+  std::atomic<int64_t> maxQueueSize_;
+  std::atomic<int64_t> numSlowCallbacks_;
+  std::atomic<int64_t> slowCallbackMicroSeconds_;
   std::unique_ptr<Poller> poller_;
-  std::unique_ptr<TimerQueue> timerQueue_;
+  std::unique_ptr<TimerScheduler> timerQueue_;
   int wakeupFd_;
   std::unique_ptr<Channel> wakeupChannel_;
   std::shared_ptr<void> context_;
@@ -118,8 +210,10 @@ class EventLoop : noncopyable {
   ChannelList activeChannels_;
   Channel *currentActiveChannel_;
 
-  mutable MutexLock mutex_;
-  std::vector<Functor> pendingFunctors_ GUARDED_BY(mutex_);
+  MpscQueue<PendingFunctor> pendingFunctors_;
+  /// true if wakeupFd_ has been written since last doPendingFunctors(),
+  /// so that wakeups of producers are coalesced.
+  std::atomic<bool> wakeupPending_;
 };
 
 }  // namespace net
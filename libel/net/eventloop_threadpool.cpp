@@ -5,6 +5,7 @@
 #include "libel/net/eventloop_threadpool.h"
 #include "libel/net/eventloop.h"
 #include "libel/net/eventloop_thread.h"
+#include "libel/net/loop_selector.h"
 
 using namespace Libel;
 using namespace Libel::net;
@@ -35,6 +36,22 @@ void EventLoopThreadPool::start(const ThreadInitCallback& cb) {
   }
   if (numThreads_ == 0 && cb)
     cb(baseLoop_);
+  if (selector_ && !loops_.empty())
+    selector_->setLoops(loops_);
+}
+
+void EventLoopThreadPool::setLoopSelector(
+    std::unique_ptr<LoopSelector> selector) {
+  assert(!started_);
+  selector_ = std::move(selector);
+}
+
+EventLoop * EventLoopThreadPool::getLoopFor(const InetAddress &peerAddr) {
+  baseLoop_->assertInLoopThread();
+  assert(started_);
+  if (!selector_ || loops_.empty())
+    return getNextLoop();
+  return selector_->select(peerAddr);
 }
 
 EventLoop * EventLoopThreadPool::getNextLoop() {
@@ -56,7 +73,8 @@ EventLoop * EventLoopThreadPool::getLoopForHash(size_t hashCode) {
   auto loop = baseLoop_;
 
   if (!loops_.empty()) {
-    loop = loops_[hashCode % loops_.size()];
+    loop = loops_[static_cast<size_t>(LoopSelector::jumpConsistentHash(
+        hashCode, static_cast<int32_t>(loops_.size())))];
   }
   return loop;
 }
@@ -18,6 +18,8 @@ namespace net {
 
 class EventLoop;
 class EventLoopThread;
+class InetAddress;
+class LoopSelector;
 
 class EventLoopThreadPool : noncopyable {
 public:
@@ -28,10 +30,20 @@ public:
   void setThreadNum(int numThreads) { numThreads_ = numThreads; }
   void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
+  /// Policy of getLoopFor(), round robin if not set.
+  /// Must be called before start().
+  void setLoopSelector(std::unique_ptr<LoopSelector> selector);
+  /// nullptr if not set
+  LoopSelector* loopSelector() const { return selector_.get(); }
+
   // round-robin policy
   EventLoop* getNextLoop();
 
-  // with the same hash code, it will always return the same eventloop
+  /// the loop chosen by the LoopSelector for a new connection from peerAddr
+  EventLoop* getLoopFor(const InetAddress& peerAddr);
+
+  // with the same hash code, it will always return the same eventloop,
+  // consistent hashing, so that few codes move if numThreads changes
   EventLoop* getLoopForHash(size_t hashCode);
 
   std::vector<EventLoop*> getAllLoops();
@@ -49,6 +61,7 @@ private:
   int next_;
   std::vector<std::unique_ptr<EventLoopThread>> threads_;
   std::vector<EventLoop*> loops_;
+  std::unique_ptr<LoopSelector> selector_;
 };
 
 
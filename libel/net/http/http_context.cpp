@@ -5,21 +5,29 @@
 #include "libel/net/http/http_context.h"
 #include "libel/net/buffer.h"
 
+#include <algorithm>
+#include <cctype>
+
 using namespace Libel;
 using namespace Libel::net;
 
+const size_t HttpContext::kMaxBodySize;
+
 bool HttpContext::processRequestLine(const char* begin, const char* end) {
   bool success = false;
   const char* start = begin;
-  const char* space = std::find(start, end, ' ');
-  if (space != end && request_.setMethod(start, space)) {
+  const char* space = CharScanner::findChar(start, end, ' ');
+  if (space && request_.setMethod(start, space)) {
     start = space + 1;
-    space = std::find(start, end, ' ');
-    if (space != end) {
-      const char* question = std::find(start, space, ' ');
-      if (question != space) {
-        request_.setPath(start, question);
-        request_.setQuery(question, space);
+    /// path ends at ' ' or '?', found in one pass
+    const char* delimiter = CharScanner::findFirstOf(start, end, "  ??", 2);
+    space = delimiter && *delimiter == '?'
+                ? CharScanner::findChar(delimiter, end, ' ')
+                : delimiter;
+    if (space) {
+      if (delimiter != space) {
+        request_.setPath(start, delimiter);
+        request_.setQuery(delimiter, space);
       } else {
         request_.setPath(start, space);
       }
@@ -38,16 +46,91 @@ bool HttpContext::processRequestLine(const char* begin, const char* end) {
   return success;
 }
 
+namespace {
+
+bool equalsIgnoreCase(const char* begin, const char* end, const char* word) {
+  return StringPiece(begin, static_cast<size_t>(end - begin))
+      .equalsIgnoreCase(word);
+}
+
+void trim(const char** begin, const char** end) {
+  while (*begin < *end && isspace(**begin)) ++*begin;
+  while (*begin < *end && isspace(*(*end - 1))) --*end;
+}
+
+}  // namespace
+
+bool HttpContext::processFramingHeader(const char* begin, const char* colon,
+                                       const char* end) {
+  const char* value = colon + 1;
+  trim(&value, &end);
+  if (equalsIgnoreCase(begin, colon, "Content-Length")) {
+    if (value == end) return false;
+    size_t length = 0;
+    for (const char* p = value; p != end; ++p) {
+      if (!isdigit(*p)) return false;
+      length = length * 10 + static_cast<size_t>(*p - '0');
+      if (length > kMaxBodySize) return false;
+    }
+    /// conflicting lengths would let a proxy and us split the stream
+    /// differently, RFC 7230 3.3.3
+    if (hasContentLength_ && length != bodyRemaining_) return false;
+    hasContentLength_ = true;
+    bodyRemaining_ = length;
+  } else if (equalsIgnoreCase(begin, colon, "Transfer-Encoding")) {
+    /// chunked must be the last coding, others are not supported
+    if (!equalsIgnoreCase(value, end, "chunked")) return false;
+    chunked_ = true;
+  }
+  return true;
+}
+
+bool HttpContext::processChunkSize(const char* begin, const char* end) {
+  /// chunk extensions are ignored
+  const char* semicolon = std::find(begin, end, ';');
+  trim(&begin, &semicolon);
+  if (begin == semicolon) return false;
+  size_t size = 0;
+  for (const char* p = begin; p != semicolon; ++p) {
+    int digit;
+    if (*p >= '0' && *p <= '9') {
+      digit = *p - '0';
+    } else if (*p >= 'a' && *p <= 'f') {
+      digit = *p - 'a' + 10;
+    } else if (*p >= 'A' && *p <= 'F') {
+      digit = *p - 'A' + 10;
+    } else {
+      return false;
+    }
+    size = size * 16 + static_cast<size_t>(digit);
+    if (size > kMaxBodySize) return false;
+  }
+  if (request_.bodySize() + size > kMaxBodySize) return false;
+  bodyRemaining_ = size;
+  return true;
+}
+
 bool HttpContext::parseRequest(Buffer* buffer, TimeStamp receiveTime) {
+  if (consumed_ > 0) {
+    /// the previous request is done with
+    buffer->retrieve(std::min(consumed_, buffer->readableBytes()));
+    consumed_ = 0;
+  }
+  /// nothing is retrieved until reset(), views of request_ are
+  /// offsets from here
+  const char* const base = buffer->peek();
+  const char* const end = buffer->beginWrite();
+  request_.setBase(base);
   bool ok = true, hasMore = true;
   while (hasMore) {
+    const char* const start = base + parsed_;
     if (state_ == kExpectRequestLine) {
-      auto crlf = buffer->findCRLF();
+      auto crlf = buffer->findCRLF(start);
       if (crlf) {
-        ok = processRequestLine(buffer->peek(), crlf);
+        ok = processRequestLine(start, crlf);
         if (ok) {
           request_.setReceiveTime(receiveTime);
-          buffer->retrieveUntil(crlf + 2);
+          parsed_ = static_cast<size_t>(crlf + 2 - base);
           state_ = kExpectHeaders;
         } else {
           hasMore = false;
@@ -56,24 +139,84 @@ bool HttpContext::parseRequest(Buffer* buffer, TimeStamp receiveTime) {
         hasMore = false;
       }
     } else if (state_ == kExpectHeaders) {
-      auto crlf = buffer->findCRLF();
+      auto crlf = buffer->findCRLF(start);
       if (crlf) {
-        const char* colon = std::find(buffer->peek(), crlf, ':');
-        if (colon != crlf) {
-          request_.addHeader(buffer->peek(), colon, crlf);
+        const char* colon = CharScanner::findChar(start, crlf, ':');
+        if (colon) {
+          ok = processFramingHeader(start, colon, crlf);
+          if (!ok) break;
+          request_.addHeader(start, colon, crlf);
         } else {
           // empty line, end of header
+          if (chunked_) {
+            /// Content-Length is ignored, as RFC 7230 3.3.3 says
+            state_ = kExpectChunkSize;
+          } else if (bodyRemaining_ > 0) {
+            state_ = kExpectBody;
+          } else {
+            state_ = kGotAll;
+            hasMore = false;
+          }
+        }
+        parsed_ = static_cast<size_t>(crlf + 2 - base);
+      } else {
+        hasMore = false;
+      }
+    } else if (state_ == kExpectBody) {
+      /// waits for the whole body, which is not copied
+      if (static_cast<size_t>(end - start) >= bodyRemaining_) {
+        request_.setBody(start, start + bodyRemaining_);
+        parsed_ += bodyRemaining_;
+        bodyRemaining_ = 0;
+        state_ = kGotAll;
+      }
+      hasMore = false;
+    } else if (state_ == kExpectChunkData) {
+      const size_t n =
+          std::min(bodyRemaining_, static_cast<size_t>(end - start));
+      request_.appendBody(start, n);
+      parsed_ += n;
+      bodyRemaining_ -= n;
+      if (bodyRemaining_ > 0 || end - (start + n) < 2) {
+        /// CRLF after chunk data
+        hasMore = false;
+      } else {
+        ok = start[n] == '\r' && start[n + 1] == '\n';
+        if (!ok) break;
+        parsed_ += 2;
+        state_ = kExpectChunkSize;
+      }
+    } else if (state_ == kExpectChunkSize) {
+      auto crlf = buffer->findCRLF(start);
+      if (crlf) {
+        ok = processChunkSize(start, crlf);
+        if (!ok) break;
+        parsed_ = static_cast<size_t>(crlf + 2 - base);
+        state_ = bodyRemaining_ > 0 ? kExpectChunkData : kExpectChunkTrailers;
+      } else {
+        hasMore = false;
+      }
+    } else if (state_ == kExpectChunkTrailers) {
+      /// trailer fields are dropped, up to the empty line
+      auto crlf = buffer->findCRLF(start);
+      if (crlf) {
+        if (crlf == start) {
           state_ = kGotAll;
           hasMore = false;
         }
-        buffer->retrieveUntil(crlf + 2);
+        parsed_ = static_cast<size_t>(crlf + 2 - base);
       } else {
         hasMore = false;
       }
-    } else if (state_ == kExpectBody) {
-      // FIXME
+    } else {
       break;
     }
   }
   return ok;
-}
\ No newline at end of file
+}
+
+void HttpContext::discard(Buffer* buffer) {
+  buffer->retrieveAll();
+  consumed_ = 0;
+  reset();
+}
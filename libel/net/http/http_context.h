@@ -20,26 +20,55 @@ public:
     kExpectRequestLine,
     kExpectHeaders,
     kExpectBody,
+    kExpectChunkSize,
+    kExpectChunkData,
+    kExpectChunkTrailers,
     kGotAll,
   };
 
-  HttpContext() : state_(kExpectRequestLine) {}
+  /// larger bodies are rejected as bad requests
+  static const size_t kMaxBodySize = 64 * 1024 * 1024;
+
+  HttpContext()
+      : state_(kExpectRequestLine),
+        parsed_(0),
+        consumed_(0),
+        bodyRemaining_(0),
+        hasContentLength_(false),
+        chunked_(false) {}
 
   // defautl copy-ctor, dtor and assignement are just fine.
 
   /// return false is any error
+  ///
+  /// Stops once a request is complete, bytes of pipelined requests
+  /// behind it are left in buffer for the next call after reset().
+  /// The body is read by Content-Length or chunked Transfer-Encoding.
+  ///
+  /// Bytes of the request stay in buffer until the next call after
+  /// reset(), getRequest() holds views into them, so buffer must not
+  /// be touched in between.
   bool parseRequest(Buffer* buffer, TimeStamp receiveTime);
 
   bool gotAll() const {
     return state_ == kGotAll;
   }
 
+  /// the bytes of request are retrieved by the next parseRequest()
   void reset() {
     state_ = kExpectRequestLine;
-    HttpRequest dummy;
-    request_.swap(dummy);
+    consumed_ += parsed_;
+    parsed_ = 0;
+    bodyRemaining_ = 0;
+    hasContentLength_ = false;
+    chunked_ = false;
+    request_.reset();
   }
 
+  /// drops the request and every byte left in buffer, e.g. once the
+  /// connection is closing
+  void discard(Buffer* buffer);
+
   const HttpRequest& getRequest() const {
     return request_;
   }
@@ -50,8 +79,21 @@ public:
 
 private:
   bool processRequestLine(const char* begin, const char* end);
+  /// picks up how the body is framed, false if it makes no sense
+  bool processFramingHeader(const char* begin, const char* colon,
+                            const char* end);
+  bool processChunkSize(const char* begin, const char* end);
 
   HttpRequestParseState state_;
+  /// bytes of the request parsed so far, from the buffer's peek()
+  size_t parsed_;
+  /// bytes of finished requests, yet to be retrieved
+  size_t consumed_;
+  /// of Content-Length body or current chunk
+  size_t bodyRemaining_;
+  /// repeated Content-Length must agree
+  bool hasContentLength_;
+  bool chunked_;
   HttpRequest request_;
 };
 
@@ -5,23 +5,42 @@
 #ifndef LIBEL_HTTP_REQUEST_H
 #define LIBEL_HTTP_REQUEST_H
 
+#include "libel/base/string_piece.h"
 #include "libel/base/timestamp.h"
 #include "libel/net/callbacks.h"
 
 #include <cassert>
+#include <cctype>
+#include <cstdint>
 #include <cstdio>
 #include <map>
+#include <vector>
 
 namespace Libel {
 
 namespace net {
 
+///
+/// Request line, headers and body are not copied, they are kept as
+/// offsets into the bytes HttpContext parsed, usually the input buffer
+/// of the connection. So the views are valid until the HTTP callback
+/// returns, copy what is needed later, e.g. getHeader().
+///
 class HttpRequest {
  public:
   enum Method { kInvalid, kGet, kPost, kHead, kPut, kDelete };
   enum Version { kUnknown, kHttp10, kHttp11 };
 
-  HttpRequest() : method_(kInvalid), version_(kUnknown) {}
+  /// headers are usually fewer, the vector grows if not
+  static const size_t kInitialHeaders = 16;
+
+  HttpRequest() : method_(kInvalid), version_(kUnknown), base_(nullptr) {
+    headers_.reserve(kInitialHeaders);
+  }
+
+  /// where parsed bytes start, offsets of views are relative to it.
+  /// Called by HttpContext whenever the bytes may have moved.
+  void setBase(const char* base) { base_ = base; }
 
   void setVersion(Version version) { version_ = version; }
 
@@ -29,7 +48,7 @@ class HttpRequest {
 
   bool setMethod(const char* start, const char* end) {
     assert(method_ == kInvalid);
-    std::string method(start, end);
+    const StringPiece method(start, static_cast<size_t>(end - start));
     if (method == "GET") {
       method_ = kGet;
     } else if (method == "POST") {
@@ -72,55 +91,138 @@ class HttpRequest {
     return result;
   }
 
-  void setPath(const char* start, const char* end) { path_.assign(start, end); }
+  void setPath(const char* start, const char* end) {
+    path_ = rangeOf(start, end);
+  }
 
-  const std::string& getPath() const { return path_; }
+  StringPiece getPath() const { return pieceOf(path_); }
 
+  /// including the leading '?'
   void setQuery(const char* start, const char* end) {
-    query_.assign(start, end);
+    query_ = rangeOf(start, end);
   }
 
-  const std::string& query() const { return query_; }
+  StringPiece query() const { return pieceOf(query_); }
 
   void setReceiveTime(TimeStamp timeStamp) { receiveTime_ = timeStamp; }
 
   TimeStamp getReceiveTime() const { return receiveTime_; }
 
+  /// start is the line, end is its CR, surrounding spaces are trimmed
   void addHeader(const char* start, const char* colon, const char* end) {
-    std::string field(start, colon);
-    ++colon;
-    while (colon < end && isspace(*colon)) ++colon;
-    std::string value(colon, end);
-    while (!value.empty() && isspace(value.back())) {
-      value.resize(value.size() - 1);
+    const char* value = colon + 1;
+    while (value < end && isspace(*value)) ++value;
+    while (end > value && isspace(*(end - 1))) --end;
+    Header header = {rangeOf(start, colon), rangeOf(value, end)};
+    headers_.push_back(header);
+  }
+
+  /// value of the first field named so, case-insensitive,
+  /// empty if none
+  StringPiece header(StringPiece field) const {
+    for (const Header& h : headers_) {
+      if (pieceOf(h.field).equalsIgnoreCase(field)) {
+        return pieceOf(h.value);
+      }
     }
+    return StringPiece();
   }
 
   std::string getHeader(const std::string& field) const {
-    std::string result;
-    const auto iter = headers_.find(field);
-    if (iter != headers_.end()) result = iter->second;
+    return header(field).as_string();
+  }
+
+  size_t numHeaders() const { return headers_.size(); }
+  StringPiece headerField(size_t i) const { return pieceOf(headers_[i].field); }
+  StringPiece headerValue(size_t i) const { return pieceOf(headers_[i].value); }
+
+  /// copies all headers, later fields of the same name are dropped
+  std::map<std::string, std::string> headers() const {
+    std::map<std::string, std::string> result;
+    for (const Header& h : headers_) {
+      result.insert(std::make_pair(pieceOf(h.field).as_string(),
+                                   pieceOf(h.value).as_string()));
+    }
     return result;
   }
 
-  const std::map<std::string, std::string>& headers() const { return headers_; }
+  /// body sent as is, e.g. by Content-Length
+  void setBody(const char* start, const char* end) {
+    body_ = rangeOf(start, end);
+  }
+
+  /// decoded body, e.g. of chunked Transfer-Encoding
+  void appendBody(const char* data, size_t len) {
+    decodedBody_.append(data, len);
+  }
+
+  /// empty if none
+  StringPiece body() const {
+    return body_.length > 0 ? pieceOf(body_) : StringPiece(decodedBody_);
+  }
+
+  size_t bodySize() const {
+    return body_.length > 0 ? body_.length : decodedBody_.size();
+  }
+
+  /// ready for the next request, keeps memory of headers and body
+  void reset() {
+    method_ = kInvalid;
+    version_ = kUnknown;
+    path_ = Range();
+    query_ = Range();
+    receiveTime_ = TimeStamp();
+    headers_.clear();
+    body_ = Range();
+    decodedBody_.clear();
+    base_ = nullptr;
+  }
 
   void swap(HttpRequest& that) {
     std::swap(method_, that.method_);
     std::swap(version_, that.version_);
-    path_.swap(that.path_);
-    query_.swap(that.query_);
+    std::swap(path_, that.path_);
+    std::swap(query_, that.query_);
     receiveTime_.swap(that.receiveTime_);
     headers_.swap(that.headers_);
+    std::swap(body_, that.body_);
+    decodedBody_.swap(that.decodedBody_);
+    std::swap(base_, that.base_);
   }
 
  private:
+  struct Range {
+    Range() : offset(0), length(0) {}
+    uint32_t offset;
+    uint32_t length;
+  };
+  struct Header {
+    Range field;
+    Range value;
+  };
+
+  Range rangeOf(const char* start, const char* end) const {
+    assert(base_ && base_ <= start && start <= end);
+    Range range;
+    range.offset = static_cast<uint32_t>(start - base_);
+    range.length = static_cast<uint32_t>(end - start);
+    return range;
+  }
+
+  StringPiece pieceOf(Range range) const {
+    return range.length > 0 ? StringPiece(base_ + range.offset, range.length)
+                            : StringPiece();
+  }
+
   Method method_;
   Version version_;
-  std::string path_;
-  std::string query_;
+  Range path_;
+  Range query_;
   TimeStamp receiveTime_;
-  std::map<std::string, std::string> headers_;
+  std::vector<Header> headers_;
+  Range body_;
+  std::string decodedBody_;
+  const char* base_;
 };
 
 }  // namespace net
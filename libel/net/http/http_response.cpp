@@ -5,30 +5,100 @@
 #include "libel/net/buffer.h"
 #include "libel/net/http/http_response.h"
 
-#include <cstdio>
+#include "libel/base/num2string.h"
+
+#include <ctime>
 
 using namespace Libel;
 using namespace Libel::net;
 
-void HttpResponse::appendToBuffer(Buffer* outputBuffer) const {
-  char buf[32] = {};
-  snprintf(buf, sizeof buf, "HTTP/1.1 %d", statusCode_);
-  outputBuffer->append(buf);
-  outputBuffer->append(statusMessage_);
-  outputBuffer->append("\r\n");
+namespace {
+
+struct StatusLine {
+  HttpResponse::HttpStatusCode code;
+  StringPiece reason;
+  StringPiece line;
+};
+
+#define LIBEL_STATUS_LINE(code, number, reason) \
+  { HttpResponse::code, reason, "HTTP/1.1 " #number " " reason "\r\n" }
+
+const StatusLine kStatusLines[] = {
+    LIBEL_STATUS_LINE(k2000k, 200, "OK"),
+    LIBEL_STATUS_LINE(k301MovePermanently, 301, "Moved Permanently"),
+    LIBEL_STATUS_LINE(k400BadRequest, 400, "Bad Request"),
+    LIBEL_STATUS_LINE(k404NotFound, 404, "Not Found"),
+};
+
+#undef LIBEL_STATUS_LINE
+
+const StatusLine* findStatusLine(HttpResponse::HttpStatusCode code) {
+  for (const StatusLine& statusLine : kStatusLines) {
+    if (statusLine.code == code) return &statusLine;
+  }
+  return nullptr;
+}
+
+/// "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n" is 37 bytes
+thread_local char t_dateHeader[64];
+thread_local size_t t_dateHeaderLength = 0;
+
+inline void append(Buffer* buffer, StringPiece piece) {
+  buffer->append(piece.data(), piece.size());
+}
+
+}  // namespace
+
+StringPiece HttpResponse::statusLine(HttpStatusCode code) {
+  const StatusLine* statusLine = findStatusLine(code);
+  return statusLine ? statusLine->line : StringPiece();
+}
+
+void HttpResponse::updateDate(TimeStamp now) {
+  time_t seconds = now.secondsSinceEpoch();
+  struct tm tm_time;
+  ::gmtime_r(&seconds, &tm_time);
+  t_dateHeaderLength = ::strftime(t_dateHeader, sizeof t_dateHeader,
+                                  "Date: %a, %d %b %Y %H:%M:%S GMT\r\n",
+                                  &tm_time);
+}
+
+StringPiece HttpResponse::dateHeader() {
+  return StringPiece(t_dateHeader, t_dateHeaderLength);
+}
+
+void HttpResponse::appendHeadersToBuffer(Buffer* outputBuffer) const {
+  const StatusLine* statusLine = findStatusLine(statusCode_);
+  if (statusLine &&
+      (statusMessage_.empty() || statusLine->reason == statusMessage_)) {
+    append(outputBuffer, statusLine->line);
+  } else {
+    char buf[16];
+    append(outputBuffer, "HTTP/1.1 ");
+    outputBuffer->append(buf, static_cast<size_t>(Util::i32toa(statusCode_, buf)));
+    append(outputBuffer, " ");
+    outputBuffer->append(statusMessage_);
+    append(outputBuffer, "\r\n");
+  }
   if (closeConnection_)
-    outputBuffer->append("Connection: close\r\n");
+    append(outputBuffer, "Connection: close\r\n");
   else {
-    snprintf(buf, sizeof buf, "Content-Length: %zd\r\n", body_.size());
-    outputBuffer->append(buf);
-    outputBuffer->append("Connection: Keep-Alive\r\n");
+    char buf[32];
+    append(outputBuffer, "Content-Length: ");
+    outputBuffer->append(buf, static_cast<size_t>(Util::u64toa(body_.size(), buf)));
+    append(outputBuffer, "\r\nConnection: Keep-Alive\r\n");
   }
+  append(outputBuffer, dateHeader());
   for (const auto& header : headers_) {
     outputBuffer->append(header.first);
-    outputBuffer->append(": ");
+    append(outputBuffer, ": ");
     outputBuffer->append(header.second);
-    outputBuffer->append("\r\n");
+    append(outputBuffer, "\r\n");
   }
-  outputBuffer->append("\r\n");
+  append(outputBuffer, "\r\n");
+}
+
+void HttpResponse::appendToBuffer(Buffer* outputBuffer) const {
+  appendHeadersToBuffer(outputBuffer);
   outputBuffer->append(body_);
 }
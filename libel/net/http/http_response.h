@@ -5,10 +5,13 @@
 #ifndef LIBEL_HTTP_RESPONSE_H
 #define LIBEL_HTTP_RESPONSE_H
 
+#include "libel/base/string_piece.h"
+#include "libel/base/timestamp.h"
 #include "libel/net/callbacks.h"
 
-#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace Libel {
 
@@ -20,7 +23,7 @@ public:
   enum HttpStatusCode {
     kUnknown,
     k2000k = 200,
-    k301MovePermanently = 400,
+    k301MovePermanently = 301,
     k400BadRequest = 400,
     k404NotFound = 404,
   };
@@ -35,6 +38,7 @@ public:
     statusCode_ = code;
   }
 
+  /// the standard reason phrase if empty
   void setStatusMessage(std::string message) {
     statusMessage_ = std::move(message);
   }
@@ -51,18 +55,43 @@ public:
     addHeader("Content-type", contentType);
   }
 
+  /// replaces the value if key is added already
   void addHeader(const std::string& key, const std::string &value) {
-    headers_[key] = value;
+    for (auto& header : headers_) {
+      if (header.first == key) {
+        header.second = value;
+        return;
+      }
+    }
+    headers_.emplace_back(key, value);
   }
 
   void setBody(std::string body) {
     body_ = std::move(body);
   }
 
+  const std::string& body() const {
+    return body_;
+  }
+
+  /// status line and headers, without body
+  void appendHeadersToBuffer(Buffer* buffer) const;
+
   void appendToBuffer(Buffer* buffer) const;
 
+  /// preformatted "HTTP/1.1 200 OK\r\n", empty for unknown codes
+  static StringPiece statusLine(HttpStatusCode code);
+
+  /// Formats the "Date:" header of this thread, which is appended to
+  /// every response once set. HttpServer calls it once per second in
+  /// each of its loops.
+  static void updateDate(TimeStamp now);
+  /// the cached "Date: ...\r\n", empty if never updated in this thread
+  static StringPiece dateHeader();
+
 private:
-  std::map<std::string, std::string> headers_;
+  /// few enough for a linear search, kept in the order added
+  std::vector<std::pair<std::string, std::string>> headers_;
   HttpStatusCode statusCode_;
   // FIXME: add http version
   std::string statusMessage_;
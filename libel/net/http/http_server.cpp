@@ -5,13 +5,20 @@
 #include "libel/net/http/http_server.h"
 
 #include "libel/base/logging.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/eventloop_threadpool.h"
 #include "libel/net/http/http_context.h"
 #include "libel/net/http/http_request.h"
 #include "libel/net/http/http_response.h"
 
+#include <cassert>
+#include <sys/uio.h>
+
 using namespace Libel;
 using namespace Libel::net;
 
+const size_t HttpServer::kMaxCopiedBody;
+
 namespace Libel {
 
 namespace net {
@@ -20,7 +27,7 @@ namespace detail {
 
 void defaultHttpCallback(const HttpRequest &, HttpResponse *resp) {
   resp->setStatusCode(HttpResponse::k404NotFound);
-  resp->setStatusMessage("Not found");
+  resp->setStatusMessage("Not Found");
   resp->setCloseConnection(true);
 }
 
@@ -36,10 +43,31 @@ HttpServer::HttpServer(EventLoop *loop, const InetAddress &listenAddr,
   server_.setMessageCallback(std::bind(&HttpServer::onMessage, this, _1, _2, _3));
 }
 
+HttpServer::~HttpServer() {
+  MutexLockGuard lock(mutex_);
+  for (const auto& timer : dateTimers_) {
+    timer.first->cancel(timer.second);
+  }
+}
+
 void HttpServer::start() {
   LOG_WARN << "HttpServer[" << server_.name()
   << "] starts listening on " << server_.ipPort();
   server_.start();
+  /// queued before any connection of the loop, so the Date header is
+  /// ready for the first response
+  for (EventLoop* loop : server_.threadPool()->getAllLoops()) {
+    loop->runInLoop(std::bind(&HttpServer::startDateTimer, this, loop));
+  }
+}
+
+void HttpServer::startDateTimer(EventLoop* loop) {
+  HttpResponse::updateDate(TimeStamp::now());
+  TimerId timerId = loop->runEvery(1.0, [] {
+    HttpResponse::updateDate(TimeStamp::now());
+  });
+  MutexLockGuard lock(mutex_);
+  dateTimers_.push_back(std::make_pair(loop, timerId));
 }
 
 void HttpServer::onConnection(const TcpConnectionPtr &connection) {
@@ -51,24 +79,54 @@ void HttpServer::onConnection(const TcpConnectionPtr &connection) {
 
 void HttpServer::onMessage(const TcpConnectionPtr &connection, Buffer *buffer, TimeStamp receiveTime) {
   std::shared_ptr<HttpContext> context = std::static_pointer_cast<HttpContext>(connection->getContext());
-  if (!context->parseRequest(buffer, receiveTime)) {
-    connection->send("HTTP/1.1 400 Bad Request\r\n\r\n");
-    connection->shutdown();
+  if (!connection->connected()) {
+    /// a response asked to close, requests after it are not served
+    context->discard(buffer);
+    return;
+  }
+  /// every complete request in buffer is served, pipelined ones included,
+  /// and their responses are written in place and leave together
+  Buffer* output = connection->beginSend();
+  assert(output);
+  bool close = false;
+  while (!close) {
+    if (!context->parseRequest(buffer, receiveTime)) {
+      StringPiece badRequest = HttpResponse::statusLine(HttpResponse::k400BadRequest);
+      output->append(badRequest.data(), badRequest.size());
+      output->append("\r\n", 2);
+      close = true;
+    } else if (context->gotAll()) {
+      close = onRequest(connection, context->getRequest(), output);
+      context->reset();
+    } else {
+      break;
+    }
   }
-  if (context->gotAll()) {
-    onRequest(connection, context->getRequest());
-    context->reset();
+  connection->endSend();
+  if (close) {
+    context->discard(buffer);
+    connection->shutdown();
   }
 }
 
-void HttpServer::onRequest(const TcpConnectionPtr &conn, const HttpRequest& req) {
-  const std::string &connection = req.getHeader("Connection");
-  bool close = connection == "close" || (req.getVersion() == HttpRequest::kHttp10 && connection != "KeepAlive");
+bool HttpServer::onRequest(const TcpConnectionPtr &conn, const HttpRequest& req, Buffer* output) {
+  StringPiece connection = req.header("Connection");
+  bool close = connection.equalsIgnoreCase("close") ||
+               (req.getVersion() == HttpRequest::kHttp10 &&
+                !connection.equalsIgnoreCase("Keep-Alive"));
   HttpResponse response(close);
   httpCallback_(req, &response);
-  Buffer buffer;
-  response.appendToBuffer(&buffer);
-  conn->send(&buffer);
-  if (response.closeConnection())
-    conn->shutdown();
-}
\ No newline at end of file
+  response.appendHeadersToBuffer(output);
+  const std::string& body = response.body();
+  if (body.size() < kMaxCopiedBody) {
+    output->append(body);
+  } else {
+    /// flushes the batch, headers are written before the body in one
+    /// writev, body is not copied
+    struct iovec vec;
+    vec.iov_base = const_cast<char *>(body.data());
+    vec.iov_len = body.size();
+    conn->send(&vec, 1);
+  }
+  return response.closeConnection();
+}
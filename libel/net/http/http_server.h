@@ -5,7 +5,12 @@
 #ifndef LIBEL_HTTP_SERVER_H
 #define LIBEL_HTTP_SERVER_H
 
+#include "libel/base/Mutex.h"
 #include "libel/net/tcp_server.h"
+#include "libel/net/timerId.h"
+
+#include <utility>
+#include <vector>
 
 namespace Libel {
 
@@ -22,9 +27,14 @@ class HttpServer : noncopyable {
  public:
   using HttpCallback = std::function<void(const HttpRequest&, HttpResponse*)>;
 
+  /// larger response bodies are sent by writev instead of being copied
+  /// into the batch of responses
+  static const size_t kMaxCopiedBody = 64 * 1024;
+
   HttpServer(EventLoop* loop, const InetAddress& listenAddr,
              const std::string& name,
              TcpServer::Option option = TcpServer::kNoReusePort);
+  ~HttpServer();
 
   EventLoop* getLoop() const { return server_.getLoop(); }
 
@@ -37,16 +47,23 @@ class HttpServer : noncopyable {
     server_.setThreadNum(numThreads);
   }
 
+  /// also starts the cached Date header in every loop, see
+  /// HttpResponse::updateDate()
   void start();
 
  private:
   void onConnection(const TcpConnectionPtr& connection);
   void onMessage(const TcpConnectionPtr& connection, Buffer* buffer,
                  TimeStamp receiveTime);
-  void onRequest(const TcpConnectionPtr&, const HttpRequest&);
+  /// appends the response to output, returns true to close the connection
+  bool onRequest(const TcpConnectionPtr&, const HttpRequest&, Buffer* output);
+  /// in loop thread
+  void startDateTimer(EventLoop* loop);
 
   TcpServer server_;
   HttpCallback httpCallback_;
+  MutexLock mutex_;
+  std::vector<std::pair<EventLoop*, TimerId>> dateTimers_ GUARDED_BY(mutex_);
 };
 
 }  // namespace net
@@ -3,6 +3,7 @@
 //
 
 #include "libel/net/http/http_context.h"
+#include "libel/net/http/http_response.h"
 #include "libel/net/buffer.h"
 
 using namespace Libel;
@@ -17,6 +18,7 @@ void testParseRequestAllInOne() {
   assert(context.parseRequest(&input, TimeStamp::now()));
   assert(context.gotAll());
   const auto& request = context.getRequest();
+  (void)request;
   assert(request.getMethod() == HttpRequest::kGet);
   assert(request.getPath() == "/index.html");
   assert(request.getVersion() == HttpRequest::kHttp11);
@@ -42,6 +44,7 @@ void testParseRequestInTwoPieces() {
     assert(context.parseRequest(&input, TimeStamp::now()));
     assert(context.gotAll());
     const HttpRequest& request = context.getRequest();
+    (void)request;
     assert(request.getMethod() == HttpRequest::kGet);
     assert(request.getPath() == "/index.html");
     assert(request.getVersion() == HttpRequest::kHttp11);
@@ -62,6 +65,7 @@ void testParseRequestEmptyHeaderValue() {
   assert(context.parseRequest(&input, TimeStamp::now()));
   assert(context.gotAll());
   const auto& request = context.getRequest();
+  (void)request;
   assert(request.getMethod() == HttpRequest::kGet);
   assert(request.getPath() == "/index.html");
   assert(request.getVersion() == HttpRequest::kHttp11);
@@ -70,6 +74,196 @@ void testParseRequestEmptyHeaderValue() {
   assert(request.getHeader("Accept-Encoding") == std::string(""));
 }
 
+void testParseRequestWithContentLength() {
+  HttpContext context;
+  Buffer input;
+  input.append("POST /submit HTTP/1.1\r\n"
+               "content-length: 11\r\n"
+               "\r\n"
+               "hello world");
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(context.gotAll());
+  const auto& request = context.getRequest();
+  (void)request;
+  assert(request.getMethod() == HttpRequest::kPost);
+  assert(request.body() == "hello world");
+  /// a view into input
+  assert(request.body().data() + 11 == input.beginWrite());
+  context.reset();
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(input.readableBytes() == 0);
+}
+
+void testParseChunkedRequestByteByByte() {
+  std::string all("PUT /upload HTTP/1.1\r\n"
+                  "Transfer-Encoding: chunked\r\n"
+                  "\r\n"
+                  "5\r\nhello\r\n"
+                  "1;name=value\r\n \r\n"
+                  "5\r\nworld\r\n"
+                  "0\r\n"
+                  "Trailer: ignored\r\n"
+                  "\r\n");
+  HttpContext context;
+  Buffer input;
+  for (size_t i = 0; i < all.size(); ++i) {
+    assert(!context.gotAll());
+    input.append(all.data() + i, 1);
+    assert(context.parseRequest(&input, TimeStamp::now()));
+  }
+  assert(context.gotAll());
+  assert(context.getRequest().getMethod() == HttpRequest::kPut);
+  assert(context.getRequest().body() == "hello world");
+  context.reset();
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(input.readableBytes() == 0);
+}
+
+void testParsePipelinedRequests() {
+  HttpContext context;
+  Buffer input;
+  input.append("POST /a HTTP/1.1\r\n"
+               "Content-Length: 3\r\n"
+               "\r\n"
+               "abc"
+               "GET /b HTTP/1.1\r\n"
+               "\r\n"
+               "POST /c HTTP/1.1\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "\r\n"
+               "3\r\nxyz\r\n0\r\n\r\n"
+               "GET /d HT");
+  const char* paths[] = {"/a", "/b", "/c"};
+  const char* bodies[] = {"abc", "", "xyz"};
+  for (int i = 0; i < 3; ++i) {
+    assert(context.parseRequest(&input, TimeStamp::now()));
+    assert(context.gotAll());
+    assert(context.getRequest().getPath() == paths[i]);
+    assert(context.getRequest().body() == bodies[i]);
+    context.reset();
+  }
+  (void)paths;
+  (void)bodies;
+  /// the incomplete one stays in buffer
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(!context.gotAll());
+  assert(input.readableBytes() == 9);
+}
+
+void testDiscard() {
+  HttpContext context;
+  Buffer input;
+  input.append("GET /a HTTP/1.0\r\n"
+               "\r\n"
+               "GET /b HTTP/1.1\r\n");
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(context.gotAll());
+  context.reset();
+  context.discard(&input);
+  assert(input.readableBytes() == 0);
+
+  input.append("GET /c HTTP/1.1\r\n"
+               "\r\n");
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(context.gotAll());
+  assert(context.getRequest().getPath() == "/c");
+}
+
+void testParseBadBody() {
+  const char* requests[] = {
+      "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+      "POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n",
+      "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab",
+      "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+      "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+      "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n",
+  };
+  for (const char* request : requests) {
+    HttpContext context;
+    Buffer input;
+    input.append(request);
+    assert(!context.parseRequest(&input, TimeStamp::now()));
+  }
+}
+
+void testParseHeaders() {
+  HttpContext context;
+  Buffer input;
+  input.append("GET /search?q=libel&page=2 HTTP/1.0\r\n"
+               "Host: www.lwj.com\r\n"
+               "X-Trace:  abc def  \r\n"
+               "x-trace: second\r\n"
+               "\r\n");
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(context.gotAll());
+  const auto& request = context.getRequest();
+  assert(request.getVersion() == HttpRequest::kHttp10);
+  assert(request.getPath() == "/search");
+  assert(request.query() == "?q=libel&page=2");
+  assert(request.numHeaders() == 3);
+  assert(request.headerField(1) == "X-Trace");
+  /// case-insensitive, first one wins
+  assert(request.header("HOST") == "www.lwj.com");
+  assert(request.header("x-TRACE") == "abc def");
+  assert(request.header("Cookie").empty());
+  const auto headers = request.headers();
+  assert(headers.size() == 3);
+  assert(headers.at("x-trace") == "second");
+  /// views point into input until the next parseRequest()
+  assert(request.getPath().data() > input.peek());
+  assert(request.getPath().data() < input.beginWrite());
+  context.reset();
+  assert(context.parseRequest(&input, TimeStamp::now()));
+  assert(!context.gotAll());
+  assert(input.readableBytes() == 0);
+}
+
+void testAppendResponse() {
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k2000k);
+  response.setContentType("text/plain");
+  response.addHeader("Server", "Libel");
+  response.addHeader("Server", "Libel2");
+  response.setBody("hello world\n");
+  Buffer output;
+  response.appendToBuffer(&output);
+  assert(output.retrieveAllAsString() ==
+         "HTTP/1.1 200 OK\r\n"
+         "Content-Length: 12\r\n"
+         "Connection: Keep-Alive\r\n"
+         "Content-type: text/plain\r\n"
+         "Server: Libel2\r\n"
+         "\r\n"
+         "hello world\n");
+
+  /// "Date:" once the thread has one, custom reason phrase
+  HttpResponse::updateDate(TimeStamp(784111777 * static_cast<int64_t>(1000000)));
+  assert(HttpResponse::dateHeader() == "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+  HttpResponse notFound(true);
+  notFound.setStatusCode(HttpResponse::k404NotFound);
+  notFound.setStatusMessage("Not found");
+  notFound.appendToBuffer(&output);
+  assert(output.retrieveAllAsString() ==
+         "HTTP/1.1 404 Not found\r\n"
+         "Connection: close\r\n"
+         "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+         "\r\n");
+  assert(HttpResponse::statusLine(HttpResponse::k301MovePermanently) ==
+         "HTTP/1.1 301 Moved Permanently\r\n");
+  assert(HttpResponse::statusLine(HttpResponse::kUnknown).empty());
+}
+
 int main() {
+  testParseRequestAllInOne();
+  testParseRequestInTwoPieces();
+  testParseRequestEmptyHeaderValue();
+  testParseHeaders();
+  testParseRequestWithContentLength();
+  testParseChunkedRequestByteByByte();
+  testParsePipelinedRequests();
+  testParseBadBody();
+  testDiscard();
+  testAppendResponse();
+  printf("http_request_test passed\n");
   return 0;
 }
\ No newline at end of file
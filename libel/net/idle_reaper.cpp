@@ -0,0 +1,85 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/idle_reaper.h"
+
+#include "libel/base/logging.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/tcp_connection.h"
+
+#include <cmath>
+
+using namespace Libel;
+using namespace Libel::net;
+
+IdleReaper::IdleReaper(EventLoop* loop, int idleSeconds)
+    : loop_(loop),
+      idleSeconds_(idleSeconds),
+      tick_(0),
+      buckets_(static_cast<size_t>(idleSeconds) + 1),
+      size_(0) {
+  assert(idleSeconds > 0);
+}
+
+void IdleReaper::start() {
+  loop_->runInLoop(std::bind(&IdleReaper::startInLoop, shared_from_this()));
+}
+
+void IdleReaper::stop() {
+  loop_->runInLoop(std::bind(&IdleReaper::stopInLoop, shared_from_this()));
+}
+
+void IdleReaper::startInLoop() {
+  loop_->assertInLoopThread();
+  /// the timer keeps us alive until stop()
+  timerId_ = loop_->runEvery(1.0, std::bind(&IdleReaper::onTick,
+                                            shared_from_this()));
+}
+
+void IdleReaper::stopInLoop() {
+  loop_->assertInLoopThread();
+  loop_->cancel(timerId_);
+  for (auto& bucket : buckets_) {
+    bucket.clear();
+  }
+  size_ = 0;
+}
+
+void IdleReaper::add(const TcpConnectionPtr& conn) {
+  loop_->assertInLoopThread();
+  assert(conn->getLoop() == loop_);
+  buckets_[static_cast<size_t>(tick_ + idleSeconds_) % buckets_.size()]
+      .push_back(conn);
+  ++size_;
+}
+
+void IdleReaper::onTick() {
+  loop_->assertInLoopThread();
+  ++tick_;
+  const size_t numBuckets = buckets_.size();
+  expiring_.swap(buckets_[static_cast<size_t>(tick_) % numBuckets]);
+  size_ -= expiring_.size();
+  TimeStamp now(TimeStamp::now());
+  for (auto& weakConn : expiring_) {
+    TcpConnectionPtr conn(weakConn.lock());
+    /// closed connections are dropped here, they don't unregister.
+    /// Disconnecting ones are kept, the peer may never close after
+    /// our shutdown().
+    if (!conn || conn->disconnected()) continue;
+    double idle = timeDiffInSeconds(now, conn->lastReceiveTime());
+    if (idle >= idleSeconds_) {
+      LOG_INFO << "IdleReaper - connection " << conn->name() << " idle for "
+               << idle << " seconds, force closing";
+      conn->forceClose();
+    } else {
+      /// read recently, comes around again when it would be idle
+      int64_t later = static_cast<int64_t>(std::ceil(idleSeconds_ - idle));
+      later = std::max<int64_t>(1, std::min<int64_t>(later, idleSeconds_));
+      buckets_[static_cast<size_t>(tick_ + later) % numBuckets].push_back(
+          std::move(weakConn));
+      ++size_;
+    }
+  }
+  expiring_.clear();
+}
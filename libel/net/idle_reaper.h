@@ -0,0 +1,69 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_IDLE_REAPER_H
+#define LIBEL_IDLE_REAPER_H
+
+#include "libel/base/noncopyable.h"
+#include "libel/net/callbacks.h"
+#include "libel/net/timerId.h"
+
+#include <memory>
+#include <vector>
+
+namespace Libel {
+
+namespace net {
+
+class EventLoop;
+
+///
+/// Internal class of TcpServer::setIdleTimeout(), one per IO loop.
+///
+/// Connections sit in a wheel of one-second buckets by weak_ptr, each
+/// connection in exactly one bucket. Reading only updates
+/// TcpConnection::lastReceiveTime(), so touching costs nothing. When a
+/// bucket comes around, connections read within idleSeconds move to a
+/// later bucket, the others are force closed. One timer per loop, not
+/// per connection.
+///
+/// A connection is closed after idle for idleSeconds to idleSeconds + 1.
+class IdleReaper : noncopyable,
+                   public std::enable_shared_from_this<IdleReaper> {
+ public:
+  IdleReaper(EventLoop* loop, int idleSeconds);
+
+  /// thread safe
+  void start();
+  /// thread safe
+  void stop();
+
+  /// in loop thread
+  void add(const TcpConnectionPtr& conn);
+
+  /// in loop thread
+  size_t size() const { return size_; }
+
+ private:
+  using Bucket = std::vector<std::weak_ptr<TcpConnection>>;
+
+  void startInLoop();
+  void stopInLoop();
+  void onTick();
+
+  EventLoop* loop_;
+  const int idleSeconds_;
+  int64_t tick_;
+  /// idleSeconds_ + 1 buckets, bucket of tick_ is being expired
+  std::vector<Bucket> buckets_;
+  /// reused for the bucket being expired
+  Bucket expiring_;
+  size_t size_;
+  TimerId timerId_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_IDLE_REAPER_H
@@ -0,0 +1,173 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/loop_selector.h"
+
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/sockets_ops.h"
+
+#include <cassert>
+
+using namespace Libel;
+using namespace Libel::net;
+
+namespace {
+
+class RoundRobinSelector : public LoopSelector {
+ public:
+  RoundRobinSelector() : next_(0) {}
+
+  EventLoop* select(const InetAddress&) override {
+    EventLoop* loop = loops_[next_];
+    if (++next_ >= loops_.size()) next_ = 0;
+    return loop;
+  }
+
+ private:
+  size_t next_;
+};
+
+class LeastPendingFunctorsSelector : public LoopSelector {
+ public:
+  LeastPendingFunctorsSelector() : next_(0) {}
+
+  EventLoop* select(const InetAddress&) override {
+    /// starts at a rotating loop, so that idle loops share the ties
+    const size_t n = loops_.size();
+    size_t best = next_;
+    size_t bestSize = loops_[best]->queueSize();
+    for (size_t i = 1; i < n && bestSize > 0; ++i) {
+      size_t index = (next_ + i) % n;
+      size_t size = loops_[index]->queueSize();
+      if (size < bestSize) {
+        best = index;
+        bestSize = size;
+      }
+    }
+    if (++next_ >= n) next_ = 0;
+    return loops_[best];
+  }
+
+ private:
+  size_t next_;
+};
+
+class ConsistentHashSelector : public LoopSelector {
+ public:
+  EventLoop* select(const InetAddress& peerAddr) override {
+    int32_t index = jumpConsistentHash(hashOfIp(peerAddr),
+                                       static_cast<int32_t>(loops_.size()));
+    return loops_[static_cast<size_t>(index)];
+  }
+};
+
+}  // namespace
+
+LoopSelector::~LoopSelector() = default;
+
+std::unique_ptr<LoopSelector> LoopSelector::newRoundRobin() {
+  return std::unique_ptr<LoopSelector>(new RoundRobinSelector);
+}
+
+std::unique_ptr<LoopSelector> LoopSelector::newLeastConnections() {
+  return std::unique_ptr<LoopSelector>(new LeastConnectionsSelector);
+}
+
+std::unique_ptr<LoopSelector> LoopSelector::newLeastPendingFunctors() {
+  return std::unique_ptr<LoopSelector>(new LeastPendingFunctorsSelector);
+}
+
+std::unique_ptr<LoopSelector> LoopSelector::newConsistentHash() {
+  return std::unique_ptr<LoopSelector>(new ConsistentHashSelector);
+}
+
+int32_t LoopSelector::jumpConsistentHash(uint64_t key, int32_t numBuckets) {
+  assert(numBuckets > 0);
+  int64_t b = -1;
+  int64_t j = 0;
+  while (j < numBuckets) {
+    b = j;
+    key = key * 2862933555777941757ULL + 1;
+    j = static_cast<int64_t>(
+        static_cast<double>(b + 1) *
+        (static_cast<double>(int64_t(1) << 31) /
+         static_cast<double>((key >> 33) + 1)));
+  }
+  return static_cast<int32_t>(b);
+}
+
+uint64_t LoopSelector::hashOfIp(const InetAddress& addr) {
+  const unsigned char* bytes;
+  size_t len;
+  if (addr.family() == AF_INET6) {
+    auto addr6 = sockets::sockaddr_in6_cast(addr.getSockAddr());
+    bytes = addr6->sin6_addr.s6_addr;
+    len = sizeof addr6->sin6_addr.s6_addr;
+  } else {
+    auto addr4 = sockets::sockaddr_in_cast(addr.getSockAddr());
+    bytes = reinterpret_cast<const unsigned char*>(&addr4->sin_addr.s_addr);
+    len = sizeof addr4->sin_addr.s_addr;
+  }
+  /// FNV-1a, then a finalizer, FNV alone leaves the high bits weak
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+LeastConnectionsSelector::LeastConnectionsSelector() : next_(0) {}
+
+LeastConnectionsSelector::~LeastConnectionsSelector() = default;
+
+void LeastConnectionsSelector::setLoops(const std::vector<EventLoop*>& loops) {
+  LoopSelector::setLoops(loops);
+  counts_.reset(new std::atomic<int64_t>[loops.size()]);
+  for (size_t i = 0; i < loops.size(); ++i) {
+    indexOf_[loops[i]] = i;
+    counts_[i] = 0;
+  }
+}
+
+EventLoop* LeastConnectionsSelector::select(const InetAddress&) {
+  const size_t n = loops_.size();
+  size_t best = next_;
+  int64_t bestCount = counts_[best].load(std::memory_order_relaxed);
+  for (size_t i = 1; i < n && bestCount > 0; ++i) {
+    size_t index = (next_ + i) % n;
+    int64_t count = counts_[index].load(std::memory_order_relaxed);
+    if (count < bestCount) {
+      best = index;
+      bestCount = count;
+    }
+  }
+  if (++next_ >= n) next_ = 0;
+  return loops_[best];
+}
+
+void LeastConnectionsSelector::connectionAdded(EventLoop* loop) {
+  auto it = indexOf_.find(loop);
+  if (it != indexOf_.end()) {
+    counts_[it->second].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LeastConnectionsSelector::connectionRemoved(EventLoop* loop) {
+  auto it = indexOf_.find(loop);
+  if (it != indexOf_.end()) {
+    counts_[it->second].fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+int64_t LeastConnectionsSelector::numConnections(EventLoop* loop) const {
+  auto it = indexOf_.find(loop);
+  return it != indexOf_.end()
+             ? counts_[it->second].load(std::memory_order_relaxed)
+             : 0;
+}
@@ -0,0 +1,94 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_LOOP_SELECTOR_H
+#define LIBEL_LOOP_SELECTOR_H
+
+#include "libel/base/noncopyable.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Libel {
+
+namespace net {
+
+class EventLoop;
+class InetAddress;
+
+///
+/// Policy of EventLoopThreadPool::getLoopFor(), which IO loop serves a
+/// new connection.
+///
+/// setLoops() is called once by EventLoopThreadPool::start(), select()
+/// in the base loop. connectionAdded() and connectionRemoved() are
+/// called by TcpServer from any thread, for policies that count.
+///
+class LoopSelector : noncopyable {
+ public:
+  virtual ~LoopSelector();
+
+  virtual void setLoops(const std::vector<EventLoop*>& loops) {
+    loops_ = loops;
+  }
+
+  /// loops is not empty
+  virtual EventLoop* select(const InetAddress& peerAddr) = 0;
+
+  virtual void connectionAdded(EventLoop* /*loop*/) {}
+  virtual void connectionRemoved(EventLoop* /*loop*/) {}
+
+  /// the same as getNextLoop()
+  static std::unique_ptr<LoopSelector> newRoundRobin();
+  /// the loop with the fewest connections
+  static std::unique_ptr<LoopSelector> newLeastConnections();
+  /// the loop with the shortest EventLoop::queueSize(), the busiest
+  /// loops are usually the ones behind on their functors
+  static std::unique_ptr<LoopSelector> newLeastPendingFunctors();
+  /// the same peer ip always goes to the same loop, and changing the
+  /// number of loops moves as few peers as possible
+  static std::unique_ptr<LoopSelector> newConsistentHash();
+
+  /// Lamping and Veach's jump consistent hash, in [0, numBuckets).
+  /// Growing numBuckets by one moves only 1 / numBuckets of the keys.
+  static int32_t jumpConsistentHash(uint64_t key, int32_t numBuckets);
+
+  /// hash of the ip of addr, port ignored
+  static uint64_t hashOfIp(const InetAddress& addr);
+
+ protected:
+  std::vector<EventLoop*> loops_;
+};
+
+///
+/// Counts connections of each loop, a new connection goes to the one
+/// with the fewest, round robin among ties.
+///
+class LeastConnectionsSelector : public LoopSelector {
+ public:
+  LeastConnectionsSelector();
+  ~LeastConnectionsSelector() override;
+
+  void setLoops(const std::vector<EventLoop*>& loops) override;
+  EventLoop* select(const InetAddress& peerAddr) override;
+  void connectionAdded(EventLoop* loop) override;
+  void connectionRemoved(EventLoop* loop) override;
+
+  /// thread safe
+  int64_t numConnections(EventLoop* loop) const;
+
+ private:
+  /// built in setLoops(), read only afterwards
+  std::map<EventLoop*, size_t> indexOf_;
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+  size_t next_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_LOOP_SELECTOR_H
@@ -9,10 +9,9 @@
 using namespace Libel;
 using namespace Libel::net;
 
-Poller::Poller(EventLoop *loop) : ownerLoop_(loop) {}
+Poller::Poller(EventLoop *loop) : ownerLoop_(loop), syscalls_(0) {}
 
 bool Poller::hasChannel(Channel *channel) const {
     assertInLoopThread();
-    auto iter = channelMap_.find(channel->fd());
-    return iter != channelMap_.end() && iter->second == channel;
+    return channels_.contains(channel->fd(), channel);
 }
\ No newline at end of file
@@ -5,10 +5,12 @@
 #ifndef LIBEL_POLLER_H
 #define LIBEL_POLLER_H
 
-#include <map>
+#include <atomic>
 #include <vector>
 
+#include "libel/base/counter.h"
 #include "libel/base/timestamp.h"
+#include "libel/net/channel_table.h"
 #include "libel/net/eventloop.h"
 
 namespace Libel {
@@ -33,18 +35,28 @@ class Poller : noncopyable {
 
     virtual bool hasChannel(Channel *channel) const;
 
+    /// whether Channel::pollEvents() may carry EPOLLET
+    virtual bool supportsEdgeTriggered() const { return false; }
+
     static Poller* newDefaultPoller(EventLoop *loop);
 
+    /// epoll_wait(2) and epoll_ctl(2), poll(2) or io_uring_enter(2)
+    /// calls so far, readable from any thread
+    int64_t syscalls() const { return Util::load(syscalls_); }
+
     void assertInLoopThread() const {
         ownerLoop_->assertInLoopThread();
     }
 
  protected:
-  using ChannelMap = std::map<int, Channel*>;
-  ChannelMap channelMap_;
+  /// in loop thread, once for each call of the kernel
+  void countSyscall() { Util::add(syscalls_, 1); }
+
+  ChannelTable channels_;
 
  private:
   EventLoop* ownerLoop_;
+  std::atomic<int64_t> syscalls_;
 };
 
 }  // namespace net
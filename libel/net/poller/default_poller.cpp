@@ -3,14 +3,21 @@
 //
 
 #include "libel/net/poller.h"
+#include "libel/base/logging.h"
 #include "libel/net/poller/poll_poller.h"
 #include "libel/net/poller/epoll_poller.h"
+#include "libel/net/poller/io_uring_poller.h"
 
 using namespace Libel::net;
 
 Poller * Poller::newDefaultPoller(EventLoop *loop) {
     if (::getenv("LIBEL_USE_POLL"))
         return new PollPoller(loop);
-    else
-        return new EpollPoller(loop);
+    if (::getenv("LIBEL_USE_IO_URING")) {
+        Poller* poller = IoUringPoller::create(loop);
+        if (poller)
+            return poller;
+        LOG_WARN << "io_uring is not supported, falling back to epoll";
+    }
+    return new EpollPoller(loop);
 }
\ No newline at end of file
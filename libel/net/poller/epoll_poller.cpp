@@ -46,6 +46,7 @@ EpollPoller::~EpollPoller() { ::close(epollfd_); }
 
 TimeStamp EpollPoller::poll(int timeoutMs, ChannelList *activeChannels) {
   LOG_TRACE << "total channels size" << activeChannels->size();
+  countSyscall();
   int numEvents = ::epoll_wait(epollfd_, events_.data(),
                                static_cast<int>(events_.size()), timeoutMs);
   auto now = TimeStamp::now();
@@ -69,12 +70,13 @@ void EpollPoller::fillActiveChannels(
     int numEvents, Libel::net::Poller::ChannelList *activeChannels) const {
   assert(implicit_cast<size_t>(numEvents) <= events_.size());
   for (int i = 0; i < numEvents; ++i) {
-    auto channel = static_cast<Channel *>(events_[i].data.ptr);
-    int fd = channel->fd();
-    auto iter = channelMap_.find(fd);
-    assert(iter != channelMap_.end());
-    assert(iter->second == channel);
-    (void)iter;
+    const uint64_t tag = events_[i].data.u64;
+    const int fd = static_cast<int>(static_cast<uint32_t>(tag));
+    auto channel = channels_.find(fd, static_cast<uint32_t>(tag >> 32));
+    if (!channel) {
+      LOG_WARN << "fd = " << fd << " event of a stale channel, ignored";
+      continue;
+    }
     channel->set_revent(events_[i].events);
     activeChannels->push_back(channel);
   }
@@ -88,19 +90,16 @@ void EpollPoller::updateChannel(Channel *channel) {
   if (index == kNew || index == kDeleted) {
     int fd = channel->fd();
     if (index == kNew) {
-      assert(channelMap_.find(fd) == channelMap_.end());
-      channelMap_[fd] = channel;
+      channels_.add(fd, channel);
     } else {
-      assert(channelMap_.find(fd) != channelMap_.end());
-      assert(channelMap_[fd] == channel);
+      assert(channels_.contains(fd, channel));
     }
     channel->set_index(kAdded);
     update(EPOLL_CTL_ADD, channel);
   } else {
     int fd = channel->fd();
     (void)fd;  // prevent compiler complaint
-    assert(channelMap_.find(fd) != channelMap_.end());
-    assert(channelMap_[fd] == channel);
+    assert(channels_.contains(fd, channel));
     assert(index == kAdded);
     if (channel->isNoneEvent()) {
       update(EPOLL_CTL_DEL, channel);
@@ -115,27 +114,26 @@ void EpollPoller::removeChannel(Channel *channel) {
   Poller::assertInLoopThread();
   int fd = channel->fd();
   LOG_TRACE << "remove channel fd:" << fd;
-  assert(channelMap_.find(fd) != channelMap_.end());
-  assert(channelMap_[fd] == channel);
   assert(channel->isNoneEvent());
   int index = channel->get_index();
-  size_t n = channelMap_.erase(fd);
-  assert(n == 1);
-  (void)n;
   if (index == kAdded) {
     update(EPOLL_CTL_DEL, channel);
   }
+  channels_.remove(fd, channel);
   channel->set_index(kNew);
 }
 
 void EpollPoller::update(int operation, Libel::net::Channel *channel) {
   struct epoll_event event {};
   memZero(&event, sizeof(event));
-  event.events = channel->events();
-  event.data.ptr = channel;
   int fd = channel->fd();
+  event.events = channel->pollEvents();
+  /// fd and generation, rather than the pointer, which may dangle
+  event.data.u64 = (static_cast<uint64_t>(channels_.generation(fd)) << 32) |
+                   static_cast<uint32_t>(fd);
   LOG_TRACE << "epoll_ctl op = " << operation2String(operation) << " event = { "
-            << Channel::events2String(fd, channel->events()) << "}";
+            << Channel::events2String(fd, channel->pollEvents()) << "}";
+  countSyscall();
   if (::epoll_ctl(epollfd_, operation, fd, &event) < 0) {
     if (operation == EPOLL_CTL_DEL) {
       LOG_ERROR << "epoll_ctl op = " << operation2String(operation)
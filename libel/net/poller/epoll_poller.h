@@ -25,6 +25,7 @@ public:
     void updateChannel(Channel *channel) override;
     // acquire: channel->isNoneEvent is true
     void removeChannel(Channel *channel) override;
+    bool supportsEdgeTriggered() const override { return true; }
 
 private:
     static const int kInitEventListSize = 16;
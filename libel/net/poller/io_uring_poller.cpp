@@ -0,0 +1,322 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/poller/io_uring_poller.h"
+
+#include "libel/base/logging.h"
+#include "libel/net/channel.h"
+
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <memory>
+
+using namespace Libel;
+using namespace Libel::net;
+
+namespace {
+
+const int kNew = -1;
+const int kAdded = 1;
+
+const unsigned kEntries = 1024;
+/// user_data of requests whose completion we don't care about
+const uint64_t kInternal = UINT64_MAX;
+
+/// what the poll request waits for, EPOLLET is the poller's business
+uint32_t pollEventsOf(const Channel* channel) {
+  return static_cast<uint32_t>(channel->pollEvents()) &
+         ~static_cast<uint32_t>(EPOLLET);
+}
+
+}  // namespace
+
+IoUringPoller::IoUringPoller(EventLoop* loop)
+    : Poller(loop),
+      ringFd_(-1),
+      nextToken_(0),
+      round_(0),
+      ring_(MAP_FAILED),
+      ringSize_(0),
+      sqes_(nullptr),
+      sqesSize_(0),
+      sqHead_(nullptr),
+      sqTail_(nullptr),
+      sqMask_(0),
+      sqEntries_(0),
+      cqHead_(nullptr),
+      cqTail_(nullptr),
+      cqMask_(0),
+      cqes_(nullptr) {}
+
+IoUringPoller::~IoUringPoller() {
+  if (sqes_) ::munmap(sqes_, sqesSize_);
+  if (ring_ != MAP_FAILED) ::munmap(ring_, ringSize_);
+  if (ringFd_ >= 0) ::close(ringFd_);
+}
+
+IoUringPoller* IoUringPoller::create(EventLoop* loop) {
+  std::unique_ptr<IoUringPoller> poller(new IoUringPoller(loop));
+  if (!poller->init() || !poller->probeMultishot()) {
+    return nullptr;
+  }
+  return poller.release();
+}
+
+bool IoUringPoller::init() {
+  struct io_uring_params params;
+  memZero(&params, sizeof params);
+  ringFd_ = static_cast<int>(::syscall(__NR_io_uring_setup, kEntries, &params));
+  if (ringFd_ < 0) {
+    LOG_WARN << "IoUringPoller io_uring_setup failed error:" << strerror(errno);
+    return false;
+  }
+  const uint32_t needed =
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & needed) != needed) {
+    LOG_WARN << "IoUringPoller kernel lacks io_uring features "
+             << (needed & ~params.features);
+    return false;
+  }
+
+  ringSize_ = std::max(
+      params.sq_off.array + params.sq_entries * sizeof(unsigned),
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+  ring_ = ::mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+  if (ring_ == MAP_FAILED) {
+    LOG_WARN << "IoUringPoller mmap ring failed error:" << strerror(errno);
+    return false;
+  }
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    LOG_WARN << "IoUringPoller mmap sqes failed error:" << strerror(errno);
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  char* ring = static_cast<char*>(ring_);
+  sqHead_ = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+  sqMask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+  sqEntries_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_entries);
+  cqHead_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+  cqMask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(ring + params.cq_off.cqes);
+  /// entry i of the ring is always sqes_[i]
+  unsigned* array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+  for (unsigned i = 0; i < sqEntries_; ++i) {
+    array[i] = i;
+  }
+  return true;
+}
+
+bool IoUringPoller::probeMultishot() {
+  int efd = ::eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (efd < 0) {
+    return false;
+  }
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = efd;
+  sqe->poll32_events = POLLIN;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = kInternal;
+  bool supported = false;
+  if (enter(pendingSubmissions(), 1, IORING_ENTER_GETEVENTS, 1000) >= 0) {
+    unsigned head = *cqHead_;
+    if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+      supported = cqe.res > 0 && (cqe.flags & IORING_CQE_F_MORE);
+      __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+    }
+  }
+  if (supported) {
+    sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = kInternal;
+    sqe->user_data = kInternal;
+    enter(pendingSubmissions(), 0, 0, -1);
+  } else {
+    LOG_WARN << "IoUringPoller kernel lacks multishot poll";
+  }
+  ::close(efd);
+  return supported;
+}
+
+unsigned IoUringPoller::pendingSubmissions() const {
+  return *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+}
+
+struct io_uring_sqe* IoUringPoller::getSqe() {
+  if (pendingSubmissions() >= sqEntries_) {
+    enter(pendingSubmissions(), 0, 0, -1);
+    if (pendingSubmissions() >= sqEntries_) {
+      LOG_FATAL << "IoUringPoller submission queue is full";
+    }
+  }
+  const unsigned tail = *sqTail_;
+  struct io_uring_sqe* sqe = &sqes_[tail & sqMask_];
+  memZero(sqe, sizeof *sqe);
+  /// the kernel reads entries only in io_uring_enter from this thread,
+  /// so the entry may be filled after being published
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  return sqe;
+}
+
+int IoUringPoller::enter(unsigned toSubmit, unsigned minComplete,
+                         unsigned flags, int timeoutMs) {
+  countSyscall();
+  long ret;
+  if (flags & IORING_ENTER_GETEVENTS) {
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memZero(&arg, sizeof arg);
+    arg.sigmask_sz = _NSIG / 8;
+    if (timeoutMs >= 0) {
+      ts.tv_sec = timeoutMs / 1000;
+      ts.tv_nsec = (timeoutMs % 1000) * 1000 * 1000;
+      arg.ts = reinterpret_cast<uint64_t>(&ts);
+    }
+    ret = ::syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete,
+                    flags | IORING_ENTER_EXT_ARG, &arg, sizeof arg);
+  } else {
+    ret = ::syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete,
+                    flags, nullptr, 0);
+  }
+  return static_cast<int>(ret);
+}
+
+TimeStamp IoUringPoller::poll(int timeoutMs, ChannelList* activeChannels) {
+  ++round_;
+  for (int fd : rearm_) {
+    const Registration& reg = registrations_[static_cast<size_t>(fd)];
+    if (reg.channel && reg.armedEvents == 0) {
+      const uint32_t events = pollEventsOf(reg.channel);
+      if (events != 0) arm(fd, events);
+    }
+  }
+  rearm_.clear();
+  /// changes made in this iteration go with the wait
+  int ret = enter(pendingSubmissions(), 1, IORING_ENTER_GETEVENTS, timeoutMs);
+  TimeStamp now(TimeStamp::now());
+  if (ret < 0 && errno != ETIME && errno != EINTR) {
+    LOG_ERROR << "IoUringPoller::poll() failed error:" << strerror(errno);
+  }
+  fillActiveChannels(activeChannels);
+  return now;
+}
+
+void IoUringPoller::fillActiveChannels(ChannelList* activeChannels) {
+  unsigned head = *cqHead_;
+  const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+    if (cqe.user_data == kInternal) continue;
+    const size_t fd = static_cast<uint32_t>(cqe.user_data);
+    const uint32_t token = static_cast<uint32_t>(cqe.user_data >> 32);
+    if (fd >= registrations_.size()) continue;
+    Registration& reg = registrations_[fd];
+    /// a poll removed or replaced since
+    if (!reg.channel || reg.token != token) continue;
+    if (!reg.multishot || !(cqe.flags & IORING_CQE_F_MORE)) {
+      /// one-shot, or multishot ended by the kernel
+      reg.armedEvents = 0;
+      rearm_.push_back(static_cast<int>(fd));
+    }
+    int revents = cqe.res;
+    if (cqe.res < 0) {
+      LOG_ERROR << "IoUringPoller poll fd = " << fd
+                << " failed error:" << strerror(-cqe.res);
+      revents = POLLERR;
+    }
+    if (reg.activeRound == round_) {
+      /// multishot may complete more than once per wait
+      reg.channel->set_revent(reg.channel->revents() | revents);
+    } else {
+      reg.activeRound = round_;
+      reg.channel->set_revent(revents);
+      activeChannels->push_back(reg.channel);
+    }
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+}
+
+void IoUringPoller::arm(int fd, uint32_t events) {
+  Registration& reg = registrations_[static_cast<size_t>(fd)];
+  struct io_uring_sqe* sqe = getSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->len = reg.multishot ? IORING_POLL_ADD_MULTI : 0;
+  sqe->user_data = userData(fd, reg.token);
+  reg.armedEvents = events;
+}
+
+void IoUringPoller::disarm(int fd) {
+  Registration& reg = registrations_[static_cast<size_t>(fd)];
+  if (reg.armedEvents != 0) {
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = userData(fd, reg.token);
+    sqe->user_data = kInternal;
+    reg.armedEvents = 0;
+  }
+  /// completions already on their way are stale from now on
+  reg.token = ++nextToken_;
+}
+
+void IoUringPoller::updateChannel(Channel* channel) {
+  Poller::assertInLoopThread();
+  const int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd << " events = " << channel->events();
+  if (channel->get_index() == kNew) {
+    channels_.add(fd, channel);
+    channel->set_index(kAdded);
+    if (static_cast<size_t>(fd) >= registrations_.size()) {
+      registrations_.resize(static_cast<size_t>(fd) + 1);
+    }
+    Registration& reg = registrations_[static_cast<size_t>(fd)];
+    reg.channel = channel;
+    reg.token = ++nextToken_;
+    reg.armedEvents = 0;
+    reg.multishot = false;
+    reg.activeRound = 0;
+  }
+  assert(channels_.contains(fd, channel));
+  Registration& reg = registrations_[static_cast<size_t>(fd)];
+  assert(reg.channel == channel);
+  const uint32_t events = pollEventsOf(channel);
+  const bool multishot = channel->edgeTriggered();
+  if (reg.armedEvents != 0) {
+    if (events == reg.armedEvents && multishot == reg.multishot) return;
+    disarm(fd);
+  }
+  reg.multishot = multishot;
+  if (events != 0) arm(fd, events);
+}
+
+void IoUringPoller::removeChannel(Channel* channel) {
+  Poller::assertInLoopThread();
+  const int fd = channel->fd();
+  LOG_TRACE << "remove channel fd:" << fd;
+  assert(channel->isNoneEvent());
+  channels_.remove(fd, channel);
+  disarm(fd);
+  registrations_[static_cast<size_t>(fd)].channel = nullptr;
+  channel->set_index(kNew);
+}
@@ -0,0 +1,118 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_IO_URING_POLLER_H
+#define LIBEL_IO_URING_POLLER_H
+
+#include "libel/net/poller.h"
+
+#include <cstdint>
+#include <vector>
+
+// forward declaration
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace Libel {
+
+namespace net {
+
+///
+/// IO Multiplexing with io_uring poll requests, through the raw
+/// io_uring_setup(2) and io_uring_enter(2) syscalls.
+///
+/// Channel changes only write submission entries into the shared ring,
+/// all of them are submitted at the end of the loop iteration by the
+/// same io_uring_enter(2) which waits for events, so a busy loop makes
+/// one syscall per iteration, instead of epoll_wait(2) plus one
+/// epoll_ctl(2) per change.
+///
+/// Only readiness goes through the ring, it is a poll backend. Reads
+/// and writes stay readv(2) and write(2) in Buffer and TcpConnection,
+/// so the saving is the epoll_ctl(2) of every interest change, e.g.
+/// write interest of output that can't be written at once. A loop
+/// without such changes makes as many syscalls as with epoll. See
+/// examples/pollbench and EventLoop::Metrics::pollerSyscalls.
+///
+/// Level triggered channels use one-shot polls, re-armed for free in the
+/// next submission. Edge triggered channels use multishot polls, see
+/// Channel::setEdgeTriggered().
+///
+/// Needs Linux 5.13, create() returns nullptr on older kernels.
+class IoUringPoller : public Poller {
+public:
+    ~IoUringPoller() override;
+
+    /// nullptr if the kernel lacks io_uring or any feature we need
+    static IoUringPoller* create(EventLoop* loop);
+
+    TimeStamp poll(int timeoutMs, ChannelList* activeChannels) override;
+    void updateChannel(Channel* channel) override;
+    // acquire: channel->isNoneEvent is true
+    void removeChannel(Channel* channel) override;
+    bool supportsEdgeTriggered() const override { return true; }
+
+private:
+    /// per fd, indexed by fd
+    struct Registration {
+        Channel* channel;
+        /// tells completions of this registration from stale ones
+        uint32_t token;
+        /// events of the armed poll, 0 if none
+        uint32_t armedEvents;
+        bool multishot;
+        /// iteration in which the channel was last put into activeChannels
+        uint64_t activeRound;
+    };
+
+    explicit IoUringPoller(EventLoop* loop);
+
+    bool init();
+    /// multishot poll is 5.13, older kernels fail it with EINVAL
+    bool probeMultishot();
+
+    /// next free submission entry, submits pending ones if the ring is full
+    struct io_uring_sqe* getSqe();
+    /// number of entries submitted, -1 on error
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+              int timeoutMs);
+    unsigned pendingSubmissions() const;
+
+    void arm(int fd, uint32_t events);
+    void disarm(int fd);
+    void fillActiveChannels(ChannelList* activeChannels);
+
+    static uint64_t userData(int fd, uint32_t token) {
+        return (static_cast<uint64_t>(token) << 32) | static_cast<uint32_t>(fd);
+    }
+
+    int ringFd_;
+    uint32_t nextToken_;
+    uint64_t round_;
+
+    /// submission and completion rings share one mapping
+    void* ring_;
+    size_t ringSize_;
+    struct io_uring_sqe* sqes_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    struct io_uring_cqe* cqes_;
+
+    std::vector<Registration> registrations_;
+    /// fds whose one-shot poll fired, re-armed before the next wait
+    std::vector<int> rearm_;
+};
+
+}
+
+}
+
+#endif //LIBEL_IO_URING_POLLER_H
@@ -18,6 +18,7 @@ using namespace Libel::net;
 PollPoller::PollPoller(Libel::net::EventLoop *loop) : Poller(loop) {}
 
 TimeStamp PollPoller::poll(int timeoutMs, ChannelList *activeChannels) {
+    countSyscall();
     int numEvents = ::poll(pollfds_.data(), pollfds_.size(), timeoutMs);
     TimeStamp now(TimeStamp::now());
 
@@ -38,10 +39,8 @@ void PollPoller::fillActiveChannels(int numOfEvents, Libel::net::Poller::Channel
     for (auto iter = pollfds_.begin(); iter != pollfds_.end() && numOfEvents > 0; ++iter) {
         if (iter->revents > 0) {
             --numOfEvents;
-            auto channel_iter = channelMap_.find(iter->fd);
-            assert(channel_iter != channelMap_.end());
-            auto channel = channel_iter->second;
-            assert(channel->fd() == iter->fd);
+            auto channel = channels_.find(iter->fd);
+            assert(channel != nullptr && channel->fd() == iter->fd);
             channel->set_revent(iter->revents);
             activeChannles->push_back(channel);
         }
@@ -53,7 +52,6 @@ void PollPoller::updateChannel(Channel *channel) {
     LOG_TRACE << "fd = " << channel->fd() << " events = " << channel->events();
     if (channel->get_index() < 0) {
         /// a new fd, add to pollfds
-        assert(channelMap_.find(channel->fd()) == channelMap_.end());
         struct pollfd pfd{};
         pfd.fd = channel->fd();
         pfd.events = static_cast<short>(channel->events());
@@ -61,11 +59,10 @@ void PollPoller::updateChannel(Channel *channel) {
         int idx = static_cast<int>(pollfds_.size());
         pollfds_.push_back(pfd);
         channel->set_index(idx);
-        channelMap_[pfd.fd] = channel;
+        channels_.add(pfd.fd, channel);
     } else {
         /// a existing one, need to be updated
-        assert(channelMap_.find(channel->fd()) != channelMap_.end());
-        assert(channelMap_[channel->fd()] == channel);
+        assert(channels_.contains(channel->fd(), channel));
         int idx = channel->get_index();
         assert(idx >= 0 && idx < static_cast<int>(pollfds_.size()));
         auto &pfd = pollfds_[idx];
@@ -84,14 +81,10 @@ void PollPoller::updateChannel(Channel *channel) {
 void PollPoller::removeChannel(Channel *channel) {
     Poller::assertInLoopThread();
     LOG_TRACE << "remove fd = " << channel->fd();
-    assert(channelMap_.find(channel->fd()) != channelMap_.end());
-    assert(channelMap_[channel->fd()] == channel);
     assert(channel->isNoneEvent());
     auto idx = channel->get_index();
     assert(idx >= 0 && idx < static_cast<int>(pollfds_.size()));
-    auto n = channelMap_.erase(channel->fd());
-    assert(n == 1);
-    (void)n;
+    channels_.remove(channel->fd(), channel);
     if (implicit_cast<size_t>(idx) == pollfds_.size() - 1) {
         pollfds_.pop_back();
     } else {
@@ -100,7 +93,7 @@ void PollPoller::removeChannel(Channel *channel) {
         if (channelFdAtEnd < 0) {
             channelFdAtEnd = -channelFdAtEnd - 1;
         }
-        channelMap_[channelFdAtEnd]->set_index(idx);
+        channels_.find(channelFdAtEnd)->set_index(idx);
         pollfds_.pop_back();
     }
 }
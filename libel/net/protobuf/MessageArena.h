@@ -0,0 +1,60 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_MESSAGEARENA_H
+#define LIBEL_MESSAGEARENA_H
+
+#include "libel/base/noncopyable.h"
+
+#include <google/protobuf/arena.h>
+
+#include <memory>
+
+namespace Libel {
+
+namespace net {
+
+///
+/// A google::protobuf::Arena with a preallocated first block, which
+/// survives reset(), so a reused arena allocates nothing from the heap
+/// unless a batch outgrows the block.
+///
+/// Messages on it are handed out as aliasing shared_ptrs of the arena,
+/// see ProtobufCodecLite::setArenaBlockSize(), so it is freed only after
+/// the last message of it is released.
+class MessageArena : noncopyable {
+ public:
+  explicit MessageArena(size_t initialBlockSize)
+      : initialBlockSize_(initialBlockSize),
+        initialBlock_(new char[initialBlockSize]),
+        arena_(options(initialBlock_.get(), initialBlockSize)) {}
+
+  google::protobuf::Arena* arena() { return &arena_; }
+
+  size_t initialBlockSize() const { return initialBlockSize_; }
+
+  /// destroys every message on it, keeps the first block
+  void reset() { arena_.Reset(); }
+
+  size_t spaceUsed() const { return static_cast<size_t>(arena_.SpaceUsed()); }
+
+ private:
+  static google::protobuf::ArenaOptions options(char* block, size_t size) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block;
+    options.initial_block_size = size;
+    return options;
+  }
+
+  const size_t initialBlockSize_;
+  std::unique_ptr<char[]> initialBlock_;
+  google::protobuf::Arena arena_;
+};
+
+using MessageArenaPtr = std::shared_ptr<MessageArena>;
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_MESSAGEARENA_H
@@ -4,17 +4,55 @@
 
 #include "libel/net/protobuf/ProtobufCodecLite.h"
 
+#include "libel/base/checksum.h"
 #include "libel/base/logging.h"
 #include "libel/net/tcp_connection.h"
 #include "libel/net/Endian.h"
+#include "libel/net/protobuf/MessageArena.h"
 #include "libel/net/protorpc/google-inl.h"
 
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <zlib.h>
 
 using namespace Libel;
 using namespace Libel::net;
 
+namespace {
+/// A codec may be shared by the IO threads of a TcpServer, so the arena
+/// of the batch being dispatched is kept per thread, not in the codec.
+thread_local const ProtobufCodecLite* t_batchCodec = nullptr;
+thread_local MessageArenaPtr t_batchArena;
+/// reset arena of an earlier batch of this thread, for the next one
+thread_local MessageArenaPtr t_spareArena;
+const MessageArenaPtr kNoArena;
+
+/// installs the batch of codec on this thread, recycles its arena after
+class BatchArenaScope : noncopyable {
+ public:
+  explicit BatchArenaScope(const ProtobufCodecLite* codec)
+      : prevCodec_(t_batchCodec), prevArena_(std::move(t_batchArena)) {
+    t_batchCodec = codec;
+    t_batchArena.reset();
+  }
+
+  ~BatchArenaScope() {
+    /// reused unless some message of the batch is still referenced
+    if (t_batchArena && t_batchArena.use_count() == 1) {
+      t_batchArena->reset();
+      t_spareArena = std::move(t_batchArena);
+    }
+    t_batchCodec = prevCodec_;
+    t_batchArena = std::move(prevArena_);
+  }
+
+ private:
+  const ProtobufCodecLite* prevCodec_;
+  MessageArenaPtr prevArena_;
+};
+}  // namespace
+
 void ProtobufCodecLite::send(const TcpConnectionPtr &conn, const ::google::protobuf::Message &message) {
   Libel::net::Buffer buffer;
   fillEmptyBuffer(&buffer, message);
@@ -27,26 +65,61 @@ void ProtobufCodecLite::fillEmptyBuffer(Libel::net::Buffer *buffer, const google
 
   int32_t byte_size = serializeToBuffer(message, buffer);
 
-  int32_t checkSum = checksum(buffer->peek(), static_cast<int>(buffer->readableBytes()));
-  buffer->appendInt32(checkSum);
-  assert(buffer->readableBytes() == tag_.size() + static_cast<uint32_t>(byte_size) + kChecksumLen);
+  finishFrame(buffer);
+  assert(buffer->readableBytes() == kHeaderLen + tag_.size() + static_cast<uint32_t>(byte_size) + kChecksumLen);
   (void) byte_size;
+}
+
+void ProtobufCodecLite::send(const TcpConnectionPtr &conn, const ::google::protobuf::Message &message,
+                             int fieldNumber, const ::google::protobuf::Message &embedded) {
+  Libel::net::Buffer buffer;
+  fillEmptyBuffer(&buffer, message, fieldNumber, embedded);
+  conn->send(&buffer);
+}
+
+void ProtobufCodecLite::fillEmptyBuffer(Libel::net::Buffer *buffer, const google::protobuf::Message &message,
+                                        int fieldNumber, const google::protobuf::Message &embedded) {
+  using google::protobuf::internal::WireFormatLite;
+  using google::protobuf::io::CodedOutputStream;
+  assert(buffer->readableBytes() == 0);
+  buffer->append(tag_);
+  serializeToBuffer(message, buffer);
+
+  /// what message.set_xxx(embedded.SerializeAsString()) would add
+  const size_t byte_size = embedded.ByteSizeLong();
+  const uint32_t fieldTag = WireFormatLite::MakeTag(fieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  buffer->ensureWriteableBytes(CodedOutputStream::VarintSize32(fieldTag) +
+                               CodedOutputStream::VarintSize32(static_cast<uint32_t>(byte_size)) +
+                               byte_size + kChecksumLen);
+  auto start = reinterpret_cast<uint8_t*>(buffer->beginWrite());
+  auto end = CodedOutputStream::WriteTagToArray(fieldTag, start);
+  end = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(byte_size), end);
+  end = embedded.SerializeWithCachedSizesToArray(end);
+  buffer->hasWritten(static_cast<size_t>(end - start));
+
+  finishFrame(buffer);
+}
+
+void ProtobufCodecLite::finishFrame(Buffer *buffer) {
+  int32_t checkSum = checksum(checksumType_, buffer->peek(), static_cast<int>(buffer->readableBytes()));
+  buffer->appendInt32(checkSum);
   int32_t len = sockets::hostToNetwork32(static_cast<int32_t>(buffer->readableBytes()));
   buffer->prepend(&len, sizeof len);
 }
 
 void ProtobufCodecLite::onMessage(const TcpConnectionPtr &conn, Buffer *buffer, TimeStamp receiveTime) {
+  BatchArenaScope batch(this);
   while (buffer->readableBytes() >= static_cast<uint32_t>(kMinMessageLen_ + kHeaderLen)) {
     const int32_t len = buffer->peekInt32();
     if (len > kMaxMessageLen || len < kMinMessageLen_) {
       errorCallback_(conn, buffer, receiveTime, kInvalidLength);
       break;
     } else if (buffer->readableBytes() >= implicit_cast<size_t>(kHeaderLen + len)) {
-      if (rawMessageCallback_ && !rawMessageCallback_(conn, std::string(buffer->peek(), kHeaderLen + len), receiveTime)) {
+      if (rawMessageCallback_ && !rawMessageCallback_(conn, StringPiece(buffer->peek(), kHeaderLen + len), receiveTime)) {
         buffer->retrieve(kHeaderLen + len);
         continue;
       }
-      MessagePtr message(prototype_->New());
+      MessagePtr message(newMessage());
       ErrorCode errorCode = parse(buffer->peek() + kHeaderLen, len, message.get());
       if (errorCode == kNoError) {
         messageCallback_(conn, message, receiveTime);
@@ -61,8 +134,25 @@ void ProtobufCodecLite::onMessage(const TcpConnectionPtr &conn, Buffer *buffer,
   }
 }
 
-bool ProtobufCodecLite::parseFromBuffer(std::string buffer, google::protobuf::Message *message) {
-  return message->ParseFromArray(buffer.data(), static_cast<int>(buffer.size()));
+MessagePtr ProtobufCodecLite::newMessage() {
+  if (arenaBlockSize_ == 0) return MessagePtr(prototype_->New());
+  if (!t_batchArena) {
+    if (t_spareArena && t_spareArena->initialBlockSize() == arenaBlockSize_) {
+      t_batchArena = std::move(t_spareArena);
+    } else {
+      t_batchArena = std::make_shared<MessageArena>(arenaBlockSize_);
+    }
+  }
+  /// shares the reference count of the arena, no allocation for it
+  return MessagePtr(t_batchArena, prototype_->New(t_batchArena->arena()));
+}
+
+const MessageArenaPtr& ProtobufCodecLite::currentArena() const {
+  return t_batchCodec == this ? t_batchArena : kNoArena;
+}
+
+bool ProtobufCodecLite::parseFromBuffer(const char *data, int len, google::protobuf::Message *message) {
+  return message->ParseFromArray(data, len);
 }
 
 int ProtobufCodecLite::serializeToBuffer(const google::protobuf::Message &message, Buffer *buffer) {
@@ -144,21 +234,40 @@ int32_t ProtobufCodecLite::checksum(const void *buffer, int len) {
   return static_cast<int32_t>(::adler32(1, static_cast<const Bytef*>(buffer), len));
 }
 
+int32_t ProtobufCodecLite::checksum(ChecksumType type, const void *buffer, int len) {
+  switch (type) {
+    case kCrc32c:
+      return static_cast<int32_t>(Util::crc32c(0, buffer, static_cast<size_t>(len)));
+    case kXxHash32:
+      return static_cast<int32_t>(Util::xxHash32(buffer, static_cast<size_t>(len)));
+    case kNoChecksum:
+      return 0;
+    case kAdler32:
+    default:
+      return checksum(buffer, len);
+  }
+}
+
 bool ProtobufCodecLite::validateChecksum(const char *buffer, int len) {
+  return validateChecksum(kAdler32, buffer, len);
+}
+
+bool ProtobufCodecLite::validateChecksum(ChecksumType type, const char *buffer, int len) {
+  if (type == kNoChecksum) return true;
   int32_t expectedCheckSum = asInt32(buffer + len - kChecksumLen);
-  int32_t checkSum = checksum(buffer, len - kChecksumLen);
+  int32_t checkSum = checksum(type, buffer, len - kChecksumLen);
   return checkSum == expectedCheckSum;
 }
 
 ProtobufCodecLite::ErrorCode ProtobufCodecLite::parse(const char *buf, int len, ::google::protobuf::Message *message) {
   ErrorCode errorCode = kNoError;
 
-  if (validateChecksum(buf, len)) {
+  if (validateChecksum(checksumType_, buf, len)) {
     if (memcmp(buf, tag_.data(), tag_.size()) == 0) {
       // parse from buffer
       const char* data = buf + tag_.size();
       int32_t dataLen = len - kChecksumLen - static_cast<int>(tag_.size());
-      if (parseFromBuffer(std::string(data, dataLen), message)) {
+      if (parseFromBuffer(data, dataLen, message)) {
         errorCode = kNoError;
       } else {
         errorCode = kParseError;
@@ -6,6 +6,7 @@
 #define LIBEL_PROTOBUFCODECLITE_H
 
 #include "libel/base/noncopyable.h"
+#include "libel/base/string_piece.h"
 #include "libel/base/timestamp.h"
 #include "libel/net/callbacks.h"
 
@@ -25,13 +26,16 @@ namespace net {
 
 typedef std::shared_ptr<google::protobuf::Message> MessagePtr;
 
+class MessageArena;
+using MessageArenaPtr = std::shared_ptr<MessageArena>;
+
 // wire format
 // Field     Length  Content
 //
 // size      4-byte  M+N+4
 // tag       M-byte could be "RPC0", etc.
 // payload   N-byte
-// checksum  4-byte adler32 of tag+payload
+// checksum  4-byte adler32 of tag+payload, see ChecksumType
 //
 // This is an internal class, you should use ProtobufCodecT instead.
 class ProtobufCodecLite : noncopyable {
@@ -49,8 +53,18 @@ class ProtobufCodecLite : noncopyable {
     kParseError,
   };
 
+  /// of the checksum field, both peers must use the same
+  enum ChecksumType {
+    kAdler32,     // the default, what every peer speaks
+    kCrc32c,      // crc32 instruction of SSE4.2
+    kXxHash32,
+    kNoChecksum,  // zero, not checked, for trusted links only
+  };
+
+  /// gets the whole frame, length header included, as a view into the
+  /// input buffer, returns false to skip parsing it
   using RawMessageCallback =
-      std::function<bool(const TcpConnectionPtr&, std::string, TimeStamp)>;
+      std::function<bool(const TcpConnectionPtr&, StringPiece, TimeStamp)>;
   using ProtobufMessageCallback = std::function<void(
       const TcpConnectionPtr&, const MessagePtr&, TimeStamp)>;
   using ErrorCallback = std::function<void(const TcpConnectionPtr&, Buffer*,
@@ -66,7 +80,9 @@ class ProtobufCodecLite : noncopyable {
         messageCallback_(std::move(protobufMessageCallback)),
         rawMessageCallback_(std::move(rawMessageCallback)),
         errorCallback_(std::move(errorCallback)),
-        kMinMessageLen_(static_cast<int>(tagArg.size()) + kChecksumLen) {}
+        kMinMessageLen_(static_cast<int>(tagArg.size()) + kChecksumLen),
+        arenaBlockSize_(0),
+        checksumType_(kAdler32) {}
 
   virtual ~ProtobufCodecLite() = default;
 
@@ -75,10 +91,39 @@ class ProtobufCodecLite : noncopyable {
   void send(const TcpConnectionPtr& conn,
             const ::google::protobuf::Message& message);
 
+  /// Sends message with embedded as its bytes field fieldNumber, the
+  /// same bytes as message.set_xxx(embedded.SerializeAsString()), but
+  /// embedded is serialized right into the frame. The field must be
+  /// unset and numbered after every field set in message.
+  void send(const TcpConnectionPtr& conn,
+            const ::google::protobuf::Message& message, int fieldNumber,
+            const ::google::protobuf::Message& embedded);
+
   void onMessage(const TcpConnectionPtr& conn, Buffer* buffer,
                  TimeStamp receiveTime);
 
-  virtual bool parseFromBuffer(std::string buffer,
+  /// Decoded messages of one onMessage() batch are allocated on a shared
+  /// MessageArena of initialBlockSize bytes, instead of one heap
+  /// allocation per nested message. The arena is reset after the batch
+  /// and reused, unless some message of it is still referenced, then it
+  /// is left to them and a new one is made. 0 disables it, the default.
+  /// The arena of a batch belongs to the thread running onMessage(), not
+  /// to the codec, so one codec may serve the IO threads of a TcpServer.
+  /// Not thread safe, before any message is received.
+  void setArenaBlockSize(size_t initialBlockSize) {
+    arenaBlockSize_ = initialBlockSize;
+  }
+
+  /// Not thread safe, before any message is sent or received.
+  void setChecksumType(ChecksumType type) { checksumType_ = type; }
+  ChecksumType checksumType() const { return checksumType_; }
+
+  /// arena of the batch this thread is dispatching, for callbacks to
+  /// allocate more messages on it, empty if disabled or not dispatching
+  const MessageArenaPtr& currentArena() const;
+
+  /// parses payload right from the input buffer, without copies
+  virtual bool parseFromBuffer(const char* data, int len,
                                google::protobuf::Message* message);
 
   virtual int serializeToBuffer(const google::protobuf::Message& message,
@@ -91,10 +136,17 @@ class ProtobufCodecLite : noncopyable {
 
   void fillEmptyBuffer(Libel::net::Buffer* buffer,
                        const google::protobuf::Message& message);
+  void fillEmptyBuffer(Libel::net::Buffer* buffer,
+                       const google::protobuf::Message& message,
+                       int fieldNumber,
+                       const google::protobuf::Message& embedded);
 
+  /// adler32
   static int32_t checksum(const void* buffer, int len);
+  static int32_t checksum(ChecksumType type, const void* buffer, int len);
 
   static bool validateChecksum(const char* buffer, int len);
+  static bool validateChecksum(ChecksumType type, const char* buffer, int len);
 
   static int32_t asInt32(const char* buffer);
 
@@ -108,6 +160,12 @@ class ProtobufCodecLite : noncopyable {
   RawMessageCallback rawMessageCallback_;
   ErrorCallback errorCallback_;
   const int kMinMessageLen_;
+  size_t arenaBlockSize_;
+  ChecksumType checksumType_;
+
+  /// checksum and length header
+  void finishFrame(Buffer* buffer);
+  MessagePtr newMessage();
 };
 
 // TAG must be a variable with external linkage, not a string literal
@@ -142,6 +200,11 @@ class ProtobufCodecLiteT {
     codec_.send(conn, message);
   }
 
+  void send(const TcpConnectionPtr& conn, const MSG& message, int fieldNumber,
+            const ::google::protobuf::Message& embedded) {
+    codec_.send(conn, message, fieldNumber, embedded);
+  }
+
   void onMessage(const TcpConnectionPtr& conn, Buffer* buf, TimeStamp receiveTime) {
     codec_.onMessage(conn, buf, receiveTime);
   }
@@ -150,6 +213,18 @@ class ProtobufCodecLiteT {
     codec_.fillEmptyBuffer(buffer, message);
   }
 
+  void setArenaBlockSize(size_t initialBlockSize) {
+    codec_.setArenaBlockSize(initialBlockSize);
+  }
+
+  void setChecksumType(ProtobufCodecLite::ChecksumType type) {
+    codec_.setChecksumType(type);
+  }
+
+  const MessageArenaPtr& currentArena() const {
+    return codec_.currentArena();
+  }
+
 private:
   void onRpcMessage(const TcpConnectionPtr& conn, const MessagePtr& message, TimeStamp receiveTime) {
     messageCallback_(conn, ::Libel::down_pointer_cast<MSG>(message), receiveTime);
@@ -0,0 +1,51 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/timestamp.h"
+#include "libel/net/protobuf/ProtobufCodecLite.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace Libel;
+using namespace Libel::net;
+
+/// keeps the checksums from being optimized away
+volatile int32_t g_sink;
+
+/// MB/s of ProtobufCodecLite::checksum() for one frame size
+double throughput(ProtobufCodecLite::ChecksumType type, const std::string& frame) {
+  const size_t kTotal = 1024 * 1024 * 1024;
+  const size_t rounds = kTotal / frame.size();
+  const int len = static_cast<int>(frame.size());
+  int32_t sum = 0;
+  TimeStamp start(TimeStamp::now());
+  for (size_t i = 0; i < rounds; ++i) {
+    sum ^= ProtobufCodecLite::checksum(type, frame.data(), len);
+  }
+  double seconds = timeDiffInSeconds(TimeStamp::now(), start);
+  g_sink = sum;
+  return static_cast<double>(rounds * frame.size()) / seconds / 1e6;
+}
+
+int main() {
+  const ProtobufCodecLite::ChecksumType types[] = {
+      ProtobufCodecLite::kAdler32, ProtobufCodecLite::kCrc32c,
+      ProtobufCodecLite::kXxHash32};
+  const char* names[] = {"adler32", "crc32c", "xxhash32"};
+  const size_t sizes[] = {1024, 64 * 1024, 4 * 1024 * 1024};
+
+  printf("%-10s", "frame");
+  for (const char* name : names) printf("%12s", name);
+  printf("   (MB/s)\n");
+  for (size_t size : sizes) {
+    std::string frame(size, '\0');
+    for (size_t i = 0; i < size; ++i) frame[i] = static_cast<char>(i * 131 + 7);
+    printf("%-10zu", size);
+    for (ProtobufCodecLite::ChecksumType type : types) {
+      printf("%12.0f", throughput(type, frame));
+    }
+    printf("\n");
+  }
+}
@@ -0,0 +1,160 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_OUTSTANDINGCALLS_H
+#define LIBEL_OUTSTANDINGCALLS_H
+
+#include "libel/base/Mutex.h"
+#include "libel/base/noncopyable.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace Libel {
+
+namespace net {
+
+///
+/// Calls waiting for their responses, by id.
+///
+/// Ids are unique and increasing, so id modulo the number of slots
+/// spreads them without hashing, and the next slots are probed when one
+/// is busy. A slot is claimed by compare-and-swap of its id, so callers
+/// on any thread insert while the loop thread takes, without a lock.
+/// A call finding kMaxProbes slots busy goes to an overflow map under a
+/// mutex instead, so the table never fills up.
+///
+/// Slots are allocated on the first insert, channels which never call
+/// cost nothing.
+template <typename Call>
+class OutstandingCalls : noncopyable {
+ public:
+  static const size_t kMaxProbes = 8;
+
+  /// numSlots must be a power of two
+  explicit OutstandingCalls(size_t numSlots = 1024)
+      : mask_(numSlots - 1), slots_(nullptr), numOverflows_(0) {
+    assert(numSlots > 0 && (numSlots & mask_) == 0);
+  }
+
+  ~OutstandingCalls() { delete[] slots_.load(std::memory_order_relaxed); }
+
+  /// thread safe, id must not be 0
+  void insert(uint64_t id, const Call& call) {
+    assert(id != kFree && id != kClaimed);
+    Slot* slots = getSlots();
+    for (size_t i = 0; i < kMaxProbes; ++i) {
+      Slot& slot = slots[(id + i) & mask_];
+      uint64_t expected = kFree;
+      if (slot.id.load(std::memory_order_relaxed) == kFree &&
+          slot.id.compare_exchange_strong(expected, kClaimed,
+                                          std::memory_order_acquire)) {
+        slot.call = call;
+        slot.id.store(id, std::memory_order_release);
+        return;
+      }
+    }
+    MutexLockGuard lock(mutex_);
+    overflow_[id] = call;
+    numOverflows_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// thread safe, removes the call into *call,
+  /// false if there is none, e.g. taken already
+  bool take(uint64_t id, Call* call) {
+    Slot* slots = slots_.load(std::memory_order_acquire);
+    if (slots) {
+      for (size_t i = 0; i < kMaxProbes; ++i) {
+        if (takeSlot(&slots[(id + i) & mask_], id, call)) return true;
+      }
+    }
+    if (numOverflows_.load(std::memory_order_relaxed) == 0) return false;
+    MutexLockGuard lock(mutex_);
+    auto it = overflow_.find(id);
+    if (it == overflow_.end()) return false;
+    *call = it->second;
+    overflow_.erase(it);
+    numOverflows_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// thread safe, takes every call, f(id, call) for each
+  template <typename F>
+  void takeAll(F f) {
+    Slot* slots = slots_.load(std::memory_order_acquire);
+    if (slots) {
+      for (size_t i = 0; i <= mask_; ++i) {
+        const uint64_t id = slots[i].id.load(std::memory_order_acquire);
+        Call call;
+        if (id != kFree && id != kClaimed && takeSlot(&slots[i], id, &call)) {
+          f(id, call);
+        }
+      }
+    }
+    std::map<uint64_t, Call> overflow;
+    {
+      MutexLockGuard lock(mutex_);
+      overflow.swap(overflow_);
+      numOverflows_.store(0, std::memory_order_relaxed);
+    }
+    for (const auto& item : overflow) {
+      f(item.first, item.second);
+    }
+  }
+
+ private:
+  static const uint64_t kFree = 0;
+  /// being written or read by the owner of the claim
+  static const uint64_t kClaimed = UINT64_MAX;
+
+  struct Slot {
+    Slot() : id(kFree), call() {}
+    std::atomic<uint64_t> id;
+    Call call;
+  };
+
+  bool takeSlot(Slot* slot, uint64_t id, Call* call) {
+    uint64_t expected = id;
+    if (slot->id.load(std::memory_order_relaxed) == id &&
+        slot->id.compare_exchange_strong(expected, kClaimed,
+                                         std::memory_order_acquire)) {
+      *call = slot->call;
+      slot->id.store(kFree, std::memory_order_release);
+      return true;
+    }
+    return false;
+  }
+
+  Slot* getSlots() {
+    Slot* slots = slots_.load(std::memory_order_acquire);
+    if (slots) return slots;
+    std::unique_ptr<Slot[]> fresh(new Slot[mask_ + 1]);
+    if (slots_.compare_exchange_strong(slots, fresh.get(),
+                                       std::memory_order_acq_rel)) {
+      return fresh.release();
+    }
+    return slots;  // another caller won
+  }
+
+  const size_t mask_;
+  std::atomic<Slot*> slots_;
+  std::atomic<size_t> numOverflows_;
+  MutexLock mutex_;
+  std::map<uint64_t, Call> overflow_ GUARDED_BY(mutex_);
+};
+
+template <typename Call>
+const size_t OutstandingCalls<Call>::kMaxProbes;
+template <typename Call>
+const uint64_t OutstandingCalls<Call>::kFree;
+template <typename Call>
+const uint64_t OutstandingCalls<Call>::kClaimed;
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_OUTSTANDINGCALLS_H
@@ -0,0 +1,99 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#undef NDEBUG
+#include "libel/net/protorpc/OutstandingCalls.h"
+
+#include "libel/base/Thread.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+struct Call {
+  uint64_t tag;
+};
+
+void testInsertTake() {
+  OutstandingCalls<Call> calls(16);
+  Call call = {0};
+  assert(!calls.take(1, &call));
+  /// more than the slots, the rest overflow
+  for (uint64_t id = 1; id <= 100; ++id) {
+    Call c = {id * 10};
+    calls.insert(id, c);
+  }
+  for (uint64_t id = 100; id >= 1; --id) {
+    assert(calls.take(id, &call));
+    assert(call.tag == id * 10);
+    assert(!calls.take(id, &call));
+  }
+  /// slots are reused
+  for (uint64_t id = 101; id <= 110; ++id) {
+    Call c = {id};
+    calls.insert(id, c);
+  }
+  int taken = 0;
+  calls.takeAll([&taken](uint64_t id, const Call& c) {
+    assert(c.tag == id);
+    ++taken;
+  });
+  assert(taken == 10);
+  assert(!calls.take(105, &call));
+}
+
+const int kThreads = 4;
+const uint64_t kCallsPerThread = 200000;
+
+struct Shared {
+  OutstandingCalls<Call> calls{256};
+  std::atomic<uint64_t> nextId{0};
+};
+
+void caller(void* arg) {
+  Shared* shared = static_cast<Shared*>(arg);
+  for (uint64_t i = 0; i < kCallsPerThread; ++i) {
+    uint64_t id = ++shared->nextId;
+    Call c = {id ^ 0x5a5a};
+    shared->calls.insert(id, c);
+  }
+}
+
+/// callers on several threads, one taker as the loop thread
+void testConcurrent() {
+  Shared shared;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back(new Thread(caller, &shared, "caller"));
+    threads.back()->start();
+  }
+  const uint64_t total = kThreads * kCallsPerThread;
+  std::vector<bool> done(total + 1, false);
+  uint64_t numTaken = 0;
+  while (numTaken < total) {
+    /// ids are taken in any order, like responses arriving
+    for (uint64_t id = 1; id <= total; id += 97) {
+      for (uint64_t k = id; k < id + 97 && k <= total; ++k) {
+        Call c;
+        if (!done[k] && shared.calls.take(k, &c)) {
+          assert(c.tag == (k ^ 0x5a5a));
+          done[k] = true;
+          ++numTaken;
+        }
+      }
+    }
+  }
+  for (auto& thread : threads) thread->join();
+  Call c;
+  assert(!shared.calls.take(1, &c));
+}
+
+int main() {
+  testInsertTake();
+  testConcurrent();
+  printf("OutstandingCalls_test passed\n");
+}
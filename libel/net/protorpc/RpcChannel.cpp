@@ -5,16 +5,54 @@
 #include "libel/net/protorpc/RpcChannel.h"
 
 #include "libel/base/logging.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/protobuf/MessageArena.h"
 #include "libel/net/protorpc/rpc.pb.h"
+#include "libel/net/tcp_connection.h"
 
 #include <google/protobuf/descriptor.h>
 
 using namespace Libel;
 using namespace Libel::net;
 
+const int RpcChannel::kDeadlineTickMilliSeconds;
+
+namespace {
+
+/// first tick not before time
+int64_t tickOf(TimeStamp time) {
+  const int64_t tickMicroSeconds = RpcChannel::kDeadlineTickMilliSeconds * 1000;
+  return (time.microSecondsSinceEpoch() + tickMicroSeconds - 1) / tickMicroSeconds;
+}
+
+}  // namespace
+
+/// holds the arena until the service is done with the call
+class RpcChannel::ArenaDoneClosure : public ::google::protobuf::Closure {
+ public:
+  ArenaDoneClosure(RpcChannel* channel, ::google::protobuf::Message* response,
+                   uint64_t id, MessageArenaPtr arena)
+      : channel_(channel),
+        response_(response),
+        id_(id),
+        arena_(std::move(arena)) {}
+
+  void Run() override {
+    channel_->sendResponse(*response_, id_);
+    delete this;
+  }
+
+ private:
+  RpcChannel* channel_;
+  ::google::protobuf::Message* response_;
+  uint64_t id_;
+  MessageArenaPtr arena_;
+};
+
 RpcChannel::RpcChannel()
     : codec_(std::bind(&RpcChannel::onRpcMessage, this, _1, _2, _3)),
       id_(0),
+      calls_(std::make_shared<CallTable>()),
       services_(nullptr) {
   LOG_INFO << "RpcChannel::ctor -" << this;
 }
@@ -23,15 +61,18 @@ RpcChannel::RpcChannel(TcpConnectionPtr conn)
     : codec_(std::bind(&RpcChannel::onRpcMessage, this, _1, _2, _3)),
       conn_(std::move(conn)),
       id_(),
+      calls_(std::make_shared<CallTable>()),
       services_(nullptr) {}
 
 RpcChannel::~RpcChannel() {
   LOG_INFO << "RpcChannel::dtor - " << this;
-  for (const auto &outstanding : outstandings_) {
-    auto out = outstanding.second;
+  /// the deadline timer may be running in the loop thread right now,
+  /// it is left to cancel itself
+  calls_->closed.store(true);
+  calls_->outstandings.takeAll([](uint64_t, const OutstandingCall &out) {
     delete out.response;
     delete out.done;
-  }
+  });
 }
 
 void RpcChannel::CallMethod(const ::google::protobuf::MethodDescriptor *method,
@@ -39,19 +80,92 @@ void RpcChannel::CallMethod(const ::google::protobuf::MethodDescriptor *method,
                             const ::google::protobuf::Message *request,
                             ::google::protobuf::Message *response,
                             ::google::protobuf::Closure *done) {
+  const uint64_t id = ++id_;
   RpcMessage message;
   message.set_type(REQUEST);
-  message.set_id(++id_);
+  message.set_id(id);
   message.set_service(method->service()->full_name());
   message.set_method(method->name());
-  message.set_request(request->SerializeAsString());
 
-  OutstandingCall out = {response, done};
-  {
-    MutexLockGuard lock(mutexLock_);
-    outstandings_[id_] = out;
+  RpcController *rpcController = dynamic_cast<RpcController *>(controller);
+  OutstandingCall out = {response, done, rpcController};
+  if (!conn_ || !conn_->connected()) {
+    failCall(out, CONNECTION_CLOSED, "not connected");
+    return;
+  }
+  calls_->outstandings.insert(id, out);
+  /// failPendingCalls() may have run before the insert
+  if (!conn_->connected()) {
+    if (calls_->outstandings.take(id, &out)) {
+      failCall(out, CONNECTION_CLOSED, "connection closed");
+    }
+    return;
+  }
+  if (rpcController && rpcController->timeout() > 0) {
+    EventLoop *loop = conn_->getLoop();
+    loop->runInLoop(
+        std::bind(&RpcChannel::addDeadline, calls_, loop, id,
+                  addTime(TimeStamp::now(), rpcController->timeout())));
+  }
+  /// request is serialized right into the frame
+  codec_.send(conn_, message, RpcMessage::kRequestFieldNumber, *request);
+}
+
+void RpcChannel::failPendingCalls() {
+  calls_->outstandings.takeAll([](uint64_t, const OutstandingCall &out) {
+    failCall(out, CONNECTION_CLOSED, "connection closed");
+  });
+}
+
+void RpcChannel::failCall(const OutstandingCall &out, ErrorCode errorCode,
+                          const std::string &reason) {
+  std::unique_ptr<google::protobuf::Message> d(out.response);
+  if (out.controller) out.controller->setFailed(errorCode, reason);
+  if (out.done) out.done->Run();
+}
+
+void RpcChannel::addDeadline(const CallTablePtr &calls, EventLoop *loop,
+                             uint64_t id, TimeStamp deadline) {
+  loop->assertInLoopThread();
+  /// the channel is gone, so is the call
+  if (calls->closed.load()) return;
+  const bool idle = calls->deadlines.empty();
+  calls->deadlines[tickOf(deadline)].push_back(id);
+  if (idle) {
+    /// one timer for every deadline, while there are any.
+    /// It holds calls, not the channel.
+    calls->deadlineTimer =
+        loop->runEvery(kDeadlineTickMilliSeconds / 1000.0,
+                       std::bind(&RpcChannel::checkDeadlines, calls, loop));
+  }
+}
+
+void RpcChannel::checkDeadlines(const CallTablePtr &calls, EventLoop *loop) {
+  loop->assertInLoopThread();
+  if (calls->closed.load()) {
+    calls->deadlines.clear();
+  }
+  const int64_t now = TimeStamp::now().microSecondsSinceEpoch() /
+                      (kDeadlineTickMilliSeconds * 1000);
+  auto &deadlines = calls->deadlines;
+  while (!deadlines.empty() && deadlines.begin()->first <= now) {
+    std::vector<uint64_t> ids;
+    ids.swap(deadlines.begin()->second);
+    deadlines.erase(deadlines.begin());
+    for (uint64_t id : ids) {
+      OutstandingCall out = {nullptr, nullptr, nullptr};
+      /// false if the response came in time
+      if (calls->outstandings.take(id, &out)) {
+        LOG_WARN << "RpcChannel::checkDeadlines - call " << id << " timed out";
+        failCall(out, TIMEOUT, "timeout");
+      }
+    }
+  }
+  if (deadlines.empty()) {
+    loop->cancel(calls->deadlineTimer);
+    /// TimerId holds the timer, which holds calls
+    calls->deadlineTimer = TimerId();
   }
-  codec_.send(conn_, message);
 }
 
 void RpcChannel::onMessage(const TcpConnectionPtr &conn, Buffer *buffer,
@@ -67,20 +181,17 @@ void RpcChannel::onRpcMessage(const TcpConnectionPtr &conn,
   if (message.type() == MessageType::RESPONSE) {
     auto id = message.id();
     assert(message.has_response() || message.has_error());
-    OutstandingCall out = {nullptr, nullptr};
-    {
-      MutexLockGuard lock(mutexLock_);
-      auto iter = outstandings_.find(id);
-      if (iter != outstandings_.end()) {
-        out = iter->second;
-        outstandings_.erase(iter);
-      }
-    }
-    if (out.response) {
+    OutstandingCall out = {nullptr, nullptr, nullptr};
+    if (calls_->outstandings.take(id, &out)) {
       std::unique_ptr<google::protobuf::Message> d(out.response);
       if (message.has_response()) {
         out.response->ParseFromString(message.response());
       }
+      if (message.has_error() && message.error() != NO_ERROR &&
+          out.controller) {
+        out.controller->setFailed(message.error(),
+                                  ErrorCode_Name(message.error()));
+      }
       if (out.done) {
         out.done->Run();
       }
@@ -97,17 +208,27 @@ void RpcChannel::onRpcMessage(const TcpConnectionPtr &conn,
         const google::protobuf::MethodDescriptor *methodDescriptor =
             descriptor->FindMethodByName(message.method());
         if (methodDescriptor) {
-          std::unique_ptr<google::protobuf::Message> request(
-              service->GetRequestPrototype(methodDescriptor).New());
+          /// both on the arena of this batch if any, freed with it
+          const MessageArenaPtr &arena = codec_.currentArena();
+          google::protobuf::Arena *pbArena = arena ? arena->arena() : nullptr;
+          google::protobuf::Message *request =
+              service->GetRequestPrototype(methodDescriptor).New(pbArena);
+          std::unique_ptr<google::protobuf::Message> requestOwner(
+              pbArena ? nullptr : request);
           if (request->ParseFromString(message.request())) {
             google::protobuf::Message *response =
-                service->GetResponsePrototype(methodDescriptor).New();
-            // response is deleted in doneCallback
+                service->GetResponsePrototype(methodDescriptor).New(pbArena);
             auto id = message.id();
-            service->CallMethod(
-                methodDescriptor, nullptr, get_pointer(request), response,
-                google::protobuf::NewCallback(this, &RpcChannel::doneCallback,
-                                              response, id));
+            google::protobuf::Closure *done;
+            if (pbArena) {
+              done = new ArenaDoneClosure(this, response, id, arena);
+            } else {
+              // response is deleted in doneCallback
+              done = google::protobuf::NewCallback(
+                  this, &RpcChannel::doneCallback, response, id);
+            }
+            service->CallMethod(methodDescriptor, nullptr, request, response,
+                                done);
             errorCode = NO_ERROR;
           } else {
             errorCode = INVALID_REQUEST;
@@ -134,9 +255,13 @@ void RpcChannel::onRpcMessage(const TcpConnectionPtr &conn,
 void RpcChannel::doneCallback(::google::protobuf::Message *response,
                               uint64_t id) {
   std::unique_ptr<google::protobuf::Message> d(response);
+  sendResponse(*response, id);
+}
+
+void RpcChannel::sendResponse(const ::google::protobuf::Message &response,
+                              uint64_t id) {
   RpcMessage message;
   message.set_type(RESPONSE);
   message.set_id(id);
-  message.set_response(response->SerializeAsString());
-  codec_.send(conn_, message);
+  codec_.send(conn_, message, RpcMessage::kResponseFieldNumber, response);
 }
@@ -5,12 +5,17 @@
 #ifndef LIBEL_RPCCHANNEL_H
 #define LIBEL_RPCCHANNEL_H
 
-#include "libel/base/Mutex.h"
+#include "libel/net/protorpc/OutstandingCalls.h"
 #include "libel/net/protorpc/RpcCodec.h"
+#include "libel/net/protorpc/RpcController.h"
+#include "libel/net/timerId.h"
 
 #include <google/protobuf/service.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <vector>
 
 // Service and RpcChannel classes are incorporated from
 // google/protobuf/service.h
@@ -71,6 +76,8 @@ namespace Libel {
 
 namespace net {
 
+class EventLoop;
+
 // Abstract interface for an RPC channel. An RpcChannel represents a
 // communication line to a Service which can be used to call that
 // Service's methods. The service may be running on other machine.
@@ -78,6 +85,10 @@ namespace net {
 // construct a stub service wrapping it.
 class RpcChannel : public ::google::protobuf::RpcChannel {
 public:
+  /// deadlines of calls are checked once per tick, in one timer,
+  /// so a call expires up to one tick late
+  static const int kDeadlineTickMilliSeconds = 10;
+
   RpcChannel();
 
   explicit RpcChannel(TcpConnectionPtr conn);
@@ -92,11 +103,33 @@ public:
     services_ = services;
   }
 
+  /// Incoming RpcMessages, and requests and responses of the served
+  /// calls, are allocated on a protobuf Arena per batch of messages,
+  /// see ProtobufCodecLite::setArenaBlockSize(). A call not done within
+  /// its batch keeps the arena alive until it is. 0 disables it.
+  /// Before any message is received.
+  void setArenaBlockSize(size_t initialBlockSize) {
+    codec_.setArenaBlockSize(initialBlockSize);
+  }
+
+  /// ProtobufCodecLite::setChecksumType(), the peer must use the same.
+  /// Before any message is sent or received.
+  void setChecksumType(ProtobufCodecLite::ChecksumType type) {
+    codec_.setChecksumType(type);
+  }
+
   // Call the given method of the remote service. The signature of this
   // procedure looks the same as Service::CallMethod(), but the requirements
   // are less strict in one important way: the request and response objects
   // need not be of any specific class as long as their descriptor are
   // method->input_type() and method->output_type().
+  //
+  // Thread safe, many callers may share one channel, their calls are
+  // pipelined on the connection and matched to responses by id.
+  //
+  // If controller is a Libel::net::RpcController, its timeout is the
+  // deadline of the call, and its errorCode() tells why a call failed.
+  // A call on a disconnected channel fails right away.
   void CallMethod(const ::google::protobuf::MethodDescriptor* method,
                   ::google::protobuf::RpcController* controller,
                   const ::google::protobuf::Message* request,
@@ -105,6 +138,11 @@ public:
 
   void onMessage(const TcpConnectionPtr& conn, Buffer* buffer, TimeStamp receiveTime);
 
+  /// Fails every pending call with CONNECTION_CLOSED, instead of leaving
+  /// them to their deadlines. RpcServer calls it when a connection goes
+  /// down, clients call it in their connection callback. Thread safe.
+  void failPendingCalls();
+
 private:
 
   void onRpcMessage(const TcpConnectionPtr& conn,
@@ -112,18 +150,47 @@ private:
                     TimeStamp receiveTime);
 
   void doneCallback(::google::protobuf::Message* response, uint64_t id);
+  void sendResponse(const ::google::protobuf::Message& response, uint64_t id);
+
+  /// done of a call whose response lives on an arena
+  class ArenaDoneClosure;
 
   struct OutstandingCall {
     ::google::protobuf::Message* response;
     ::google::protobuf::Closure* done;
+    /// nullptr if the caller didn't pass a Libel::net::RpcController
+    RpcController* controller;
   };
 
+  /// Outstanding calls and their deadlines. Shared with the deadline
+  /// timer and the functors queued to the loop of the connection, which
+  /// may outlive the channel.
+  struct CallTable {
+    CallTable() : closed(false) {}
+
+    OutstandingCalls<OutstandingCall> outstandings;
+    /// set by ~RpcChannel, the timer cancels itself on its next tick
+    std::atomic<bool> closed;
+    /// in loop thread only, ids of calls by the tick their deadline is
+    /// in, taken calls are skipped when the tick comes
+    std::map<int64_t, std::vector<uint64_t>> deadlines;
+    TimerId deadlineTimer;
+  };
+  using CallTablePtr = std::shared_ptr<CallTable>;
+
+  /// runs done with controller failed, deletes response
+  static void failCall(const OutstandingCall& out, ErrorCode errorCode,
+                       const std::string& reason);
+  /// in loop thread
+  static void addDeadline(const CallTablePtr& calls, EventLoop* loop,
+                          uint64_t id, TimeStamp deadline);
+  static void checkDeadlines(const CallTablePtr& calls, EventLoop* loop);
+
   RpcCodec codec_;
   TcpConnectionPtr conn_;
   std::atomic<uint64_t> id_;
 
-  MutexLock mutexLock_;
-  std::map<uint64_t, OutstandingCall> outstandings_ GUARDED_BY(mutexLock_);
+  CallTablePtr calls_;
 
   const std::map<std::string, ::google::protobuf::Service*> *services_;
 };
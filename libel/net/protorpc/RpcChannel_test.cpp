@@ -0,0 +1,202 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#undef NDEBUG
+#include "libel/net/protorpc/RpcChannel.h"
+
+#include "libel/base/countdown_latch.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/eventloop_thread.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/protorpc/RpcServer.h"
+#include "libel/net/protorpc/rpcservice.pb.h"
+#include "libel/net/tcp_client.h"
+
+#include <cstdio>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+/// answers listRpc, holds getService until answerHeld()
+class TestService : public RpcService {
+ public:
+  ~TestService() override {
+    for (auto& call : held_) {
+      delete call.first;
+      delete call.second;
+    }
+  }
+
+  void listRpc(::google::protobuf::RpcController*, const ListRpcRequest* request,
+               ListRpcResponse* response, ::google::protobuf::Closure* done) override {
+    response->set_error(NO_ERROR);
+    response->add_service_name(request->service_name());
+    done->Run();
+  }
+
+  void getService(::google::protobuf::RpcController*, const GetServiceRequest*,
+                  GetServiceResponse* response, ::google::protobuf::Closure* done) override {
+    held_.push_back(std::make_pair(response, done));
+  }
+
+  void answerHeld() {
+    for (auto& call : held_) {
+      call.first->set_error(NO_ERROR);
+      call.second->Run();
+    }
+    held_.clear();
+  }
+
+ private:
+  std::vector<std::pair<GetServiceResponse*, ::google::protobuf::Closure*>> held_;
+};
+
+///
+/// one call answered, one timed out, one failed by disconnection,
+/// one refused as not connected
+class Client {
+ public:
+  Client(EventLoop* loop, const InetAddress& serverAddr, TestService* service)
+      : loop_(loop),
+        client_(loop, serverAddr, "RpcChannelTest"),
+        channel_(new RpcChannel),
+        stub_(get_pointer(channel_)),
+        service_(service),
+        step_(0) {
+    client_.setConnectionCallback(std::bind(&Client::onConnection, this, _1));
+    client_.setMessageCallback(
+        std::bind(&RpcChannel::onMessage, get_pointer(channel_), _1, _2, _3));
+  }
+
+  void connect() { client_.connect(); }
+  int step() const { return step_; }
+
+ private:
+  void onConnection(const TcpConnectionPtr& conn) {
+    channel_->setConnection(conn);
+    if (conn->connected()) {
+      ListRpcRequest request;
+      request.set_service_name("echo");
+      stub_.listRpc(&controller_, &request, new ListRpcResponse,
+                    google::protobuf::NewCallback(this, &Client::onListed));
+    } else {
+      channel_->failPendingCalls();
+    }
+  }
+
+  void onListed() {
+    assert(!controller_.Failed());
+    step_ = 1;
+    controller_.Reset();
+    controller_.setTimeout(0.05);
+    start_ = TimeStamp::now();
+    GetServiceRequest request;
+    request.set_service_name("echo");
+    stub_.getService(&controller_, &request, new GetServiceResponse,
+                     google::protobuf::NewCallback(this, &Client::onTimeout));
+  }
+
+  void onTimeout() {
+    double elapsed = timeDiffInSeconds(TimeStamp::now(), start_);
+    assert(controller_.Failed());
+    assert(controller_.errorCode() == TIMEOUT);
+    assert(elapsed >= 0.05 && elapsed < 1.0);
+    step_ = 2;
+    /// the late response is dropped
+    service_->answerHeld();
+
+    controller_.Reset();
+    GetServiceRequest request;
+    request.set_service_name("echo");
+    stub_.getService(&controller_, &request, new GetServiceResponse,
+                     google::protobuf::NewCallback(this, &Client::onClosed));
+    loop_->runAfter(0.05, std::bind(&TcpClient::disconnect, &client_));
+  }
+
+  void onClosed() {
+    assert(controller_.errorCode() == CONNECTION_CLOSED);
+    step_ = 3;
+    controller_.Reset();
+    ListRpcRequest request;
+    stub_.listRpc(&controller_, &request, new ListRpcResponse,
+                  google::protobuf::NewCallback(this, &Client::onRefused));
+  }
+
+  void onRefused() {
+    assert(controller_.errorCode() == CONNECTION_CLOSED);
+    step_ = 4;
+    loop_->quit();
+  }
+
+  EventLoop* loop_;
+  TcpClient client_;
+  RpcChannelPtr channel_;
+  RpcService::Stub stub_;
+  TestService* service_;
+  RpcController controller_;
+  TimeStamp start_;
+  int step_;
+};
+
+/// a channel destroyed off its loop, with a deadline pending and maybe
+/// still queued to the loop
+void testDestroyedChannel() {
+  EventLoopThread loopThread;
+  EventLoop* loop = loopThread.startLoop();
+  TcpClient client(loop, InetAddress("127.0.0.1", 20623), "RpcChannelTestDestroyed");
+  RpcChannelPtr channel(new RpcChannel);
+  TcpConnectionPtr connection;
+  CountDownLatch connected(1);
+  CountDownLatch closed(1);
+  client.setConnectionCallback(
+      [&channel, &connection, &connected, &closed](const TcpConnectionPtr& conn) {
+        if (conn->connected()) {
+          channel->setConnection(conn);
+          connection = conn;
+          connected.countDown();
+        } else {
+          closed.countDown();
+        }
+      });
+  client.connect();
+  connected.wait();
+
+  RpcController controller;
+  controller.setTimeout(0.05);
+  RpcService::Stub stub(get_pointer(channel));
+  ListRpcRequest request;
+  request.set_service_name("echo");
+  /// the server loop doesn't run yet, no answer before the deadline
+  stub.listRpc(&controller, &request, new ListRpcResponse,
+               google::protobuf::NewCallback([] { assert(false); }));
+  channel.reset();
+  /// past the deadline, the timer must not touch the channel
+  ::usleep(200 * 1000);
+  /// the server loop doesn't run yet, so we close
+  connection->forceClose();
+  closed.wait();
+  connection.reset();
+  /// until the client lets the connection go
+  ::usleep(100 * 1000);
+}
+
+int main() {
+  EventLoop loop;
+  InetAddress listenAddr(20623);
+  TestService service;
+  RpcServer server(&loop, listenAddr);
+  server.registerService(&service);
+  server.start();
+  /// before the server loop runs, the connection waits in the backlog
+  testDestroyedChannel();
+  Client client(&loop, InetAddress("127.0.0.1", 20623), &service);
+  client.connect();
+  loop.runAfter(5, [&loop] { loop.quit(); });
+  loop.loop();
+  assert(client.step() == 4);
+  printf("RpcChannel_test passed\n");
+}
@@ -4,10 +4,13 @@
 
 #undef NDEBUG
 #include "libel/net/protorpc/RpcCodec.h"
+#include "libel/base/Thread.h"
 #include "libel/net/buffer.h"
+#include "libel/net/protobuf/MessageArena.h"
 #include "libel/net/protobuf/ProtobufCodecLite.h"
 #include "libel/net/protorpc/rpc.pb.h"
 
+#include <atomic>
 #include <cstdio>
 
 using namespace Libel;
@@ -34,6 +37,176 @@ void print(const Buffer& buffer) {
 
 char rpctag[] = "RPC0";
 
+/// remembers where the payload was parsed from
+class PeekingCodec : public ProtobufCodecLite {
+ public:
+  using ProtobufCodecLite::ProtobufCodecLite;
+
+  bool parseFromBuffer(const char* data, int len,
+                       google::protobuf::Message* message) override {
+    parsedFrom = data;
+    return ProtobufCodecLite::parseFromBuffer(data, len, message);
+  }
+
+  const char* parsedFrom = nullptr;
+};
+
+StringPiece g_raw;
+
+bool rawMessageCallback(const TcpConnectionPtr&, StringPiece frame, TimeStamp) {
+  g_raw = frame;
+  return frame.size() > 0;
+}
+
+void testParseInPlace(const RpcMessage& message) {
+  Buffer buffer;
+  PeekingCodec codec(&RpcMessage::default_instance(), "RPC0", messageCallback,
+                     rawMessageCallback);
+  codec.fillEmptyBuffer(&buffer, message);
+  const char* frame = buffer.peek();
+  const size_t frameLen = buffer.readableBytes();
+  codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+  /// neither the raw callback nor parsing copied the frame
+  assert(g_raw.data() == frame);
+  assert(g_raw.size() == frameLen);
+  assert(codec.parsedFrom == frame + ProtobufCodecLite::kHeaderLen + 4);
+  assert(g_msgptr);
+  assert(g_msgptr->DebugString() == message.DebugString());
+  assert(buffer.readableBytes() == 0);
+  g_msgptr.reset();
+}
+
+void testArena(const RpcMessage& message) {
+  ProtobufCodecLite codec(&RpcMessage::default_instance(), "RPC0", messageCallback);
+  codec.setArenaBlockSize(4096);
+  Buffer buffer;
+  codec.fillEmptyBuffer(&buffer, message);
+  codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+  assert(g_msgptr);
+  assert(g_msgptr->GetArena() != nullptr);
+  /// a kept message keeps its arena, the next batch gets another one
+  MessagePtr kept = g_msgptr;
+  assert(!codec.currentArena());
+  RpcMessage other;
+  other.set_type(RESPONSE);
+  other.set_id(3);
+  codec.fillEmptyBuffer(&buffer, other);
+  codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+  assert(kept->DebugString() == message.DebugString());
+  assert(g_msgptr->DebugString() == other.DebugString());
+  assert(g_msgptr->GetArena() != kept->GetArena());
+  kept.reset();
+  g_msgptr.reset();
+  /// nobody holds it, reset and reused by the next batch
+  codec.fillEmptyBuffer(&buffer, message);
+  codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+  google::protobuf::Arena* reused = g_msgptr->GetArena();
+  g_msgptr.reset();
+  codec.fillEmptyBuffer(&buffer, message);
+  codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+  assert(g_msgptr->GetArena() == reused);
+  assert(g_msgptr->DebugString() == message.DebugString());
+  g_msgptr.reset();
+}
+
+/// one codec serving the batches of two IO threads at once
+void testSharedArena() {
+  const int kBatches = 2000;
+  std::atomic<int> checked(0);
+  ProtobufCodecLite codec(
+      &RpcMessage::default_instance(), "RPC0",
+      [&codec, &checked](const TcpConnectionPtr&, const MessagePtr& msg,
+                         TimeStamp) {
+        /// on the arena of this thread's batch, not the other thread's
+        const MessageArenaPtr& arena = codec.currentArena();
+        assert(arena && msg->GetArena() == arena->arena());
+        ++checked;
+      });
+  codec.setArenaBlockSize(4096);
+  Thread::ThreadFunc dispatch = [&codec, kBatches](void*) {
+    RpcMessage message;
+    message.set_type(REQUEST);
+    message.set_method("Echo");
+    Buffer buffer;
+    for (int i = 0; i < kBatches; ++i) {
+      message.set_id(static_cast<uint64_t>(i));
+      codec.fillEmptyBuffer(&buffer, message);
+      codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+      assert(!codec.currentArena());
+    }
+  };
+  Thread t1(dispatch, nullptr, "io1");
+  Thread t2(dispatch, nullptr, "io2");
+  t1.start();
+  t2.start();
+  t1.join();
+  t2.join();
+  assert(checked == 2 * kBatches);
+}
+
+ProtobufCodecLite::ErrorCode g_error = ProtobufCodecLite::kNoError;
+
+void errorCallback(const TcpConnectionPtr&, Buffer*, TimeStamp,
+                   ProtobufCodecLite::ErrorCode errorCode) {
+  g_error = errorCode;
+}
+
+void testChecksumTypes(const RpcMessage& message) {
+  const ProtobufCodecLite::ChecksumType types[] = {
+      ProtobufCodecLite::kAdler32, ProtobufCodecLite::kCrc32c,
+      ProtobufCodecLite::kXxHash32, ProtobufCodecLite::kNoChecksum};
+  for (ProtobufCodecLite::ChecksumType type : types) {
+    ProtobufCodecLite codec(&RpcMessage::default_instance(), "RPC0",
+                            messageCallback, ProtobufCodecLite::RawMessageCallback(),
+                            errorCallback);
+    codec.setChecksumType(type);
+    Buffer buffer;
+    codec.fillEmptyBuffer(&buffer, message);
+    Buffer copy;
+    copy.append(buffer.peek(), buffer.readableBytes());
+    codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
+    assert(g_error == ProtobufCodecLite::kNoError);
+    assert(g_msgptr && g_msgptr->DebugString() == message.DebugString());
+    g_msgptr.reset();
+
+    /// a flipped payload byte is caught, except without checksum
+    copy.beginWrite()[-5] = static_cast<char>(copy.beginWrite()[-5] ^ 0x01);
+    codec.onMessage(TcpConnectionPtr(), &copy, TimeStamp::now());
+    if (type == ProtobufCodecLite::kNoChecksum) {
+      assert(g_error == ProtobufCodecLite::kNoError);
+    } else {
+      assert(g_error == ProtobufCodecLite::kCheckSumError);
+      assert(!g_msgptr);
+    }
+    g_msgptr.reset();
+    g_error = ProtobufCodecLite::kNoError;
+  }
+}
+
+void testEmbedded() {
+  RpcMessage request;
+  request.set_type(REQUEST);
+  request.set_id(7);
+  request.set_service(std::string(300, 's'));  // length takes two bytes
+  RpcMessage message;
+  message.set_type(REQUEST);
+  message.set_id(8);
+  message.set_service("Service");
+  message.set_method("Method");
+
+  ProtobufCodecLite codec(&RpcMessage::default_instance(), "RPC0", messageCallback);
+  Buffer embedded;
+  codec.fillEmptyBuffer(&embedded, message, RpcMessage::kRequestFieldNumber, request);
+  RpcMessage nested = message;
+  nested.set_request(request.SerializeAsString());
+  Buffer copied;
+  codec.fillEmptyBuffer(&copied, nested);
+  assert(embedded.toString() == copied.toString());
+  codec.onMessage(TcpConnectionPtr(), &embedded, TimeStamp::now());
+  assert(g_msgptr && g_msgptr->DebugString() == nested.DebugString());
+  g_msgptr.reset();
+}
+
 int main() {
   RpcMessage message;
   message.set_type(REQUEST);
@@ -69,7 +242,13 @@ int main() {
     codec.onMessage(TcpConnectionPtr(), &buffer, TimeStamp::now());
     assert(g_msgptr);
     assert(g_msgptr->DebugString() == message.DebugString());
+    g_msgptr.reset();
   }
+  testParseInPlace(message);
+  testArena(message);
+  testSharedArena();
+  testChecksumTypes(message);
+  testEmbedded();
   google::protobuf::ShutdownProtobufLibrary();
 }
 
@@ -0,0 +1,55 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/protorpc/RpcController.h"
+
+using namespace Libel;
+using namespace Libel::net;
+
+RpcController::RpcController()
+    : timeout_(0),
+      errorCode_(NO_ERROR),
+      failed_(false),
+      canceled_(false),
+      cancelCallback_(nullptr) {}
+
+RpcController::~RpcController() { delete cancelCallback_; }
+
+void RpcController::setFailed(ErrorCode errorCode, const std::string& reason) {
+  errorCode_ = errorCode;
+  errorText_ = reason;
+}
+
+void RpcController::Reset() {
+  timeout_ = 0;
+  errorCode_ = NO_ERROR;
+  failed_ = false;
+  canceled_ = false;
+  errorText_.clear();
+  delete cancelCallback_;
+  cancelCallback_ = nullptr;
+}
+
+void RpcController::StartCancel() {
+  canceled_ = true;
+  if (cancelCallback_) {
+    ::google::protobuf::Closure* callback = cancelCallback_;
+    cancelCallback_ = nullptr;
+    callback->Run();
+  }
+}
+
+void RpcController::SetFailed(const std::string& reason) {
+  failed_ = true;
+  errorText_ = reason;
+}
+
+void RpcController::NotifyOnCancel(::google::protobuf::Closure* callback) {
+  if (canceled_) {
+    callback->Run();
+  } else {
+    delete cancelCallback_;
+    cancelCallback_ = callback;
+  }
+}
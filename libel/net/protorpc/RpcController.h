@@ -0,0 +1,62 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_RPCCONTROLLER_H
+#define LIBEL_RPCCONTROLLER_H
+
+#include "libel/net/protorpc/rpc.pb.h"
+
+#include <google/protobuf/service.h>
+
+#include <string>
+
+namespace Libel {
+
+namespace net {
+
+///
+/// Per call settings and outcome for RpcChannel::CallMethod().
+///
+/// The call fails with TIMEOUT if no response arrives within
+/// setTimeout() seconds, and with CONNECTION_CLOSED if the connection
+/// drops first, then done runs with Failed() true. Must outlive the
+/// call, reuse it after Reset().
+class RpcController : public ::google::protobuf::RpcController {
+ public:
+  RpcController();
+  ~RpcController() override;
+
+  /// 0 for no deadline, the default
+  void setTimeout(double seconds) { timeout_ = seconds; }
+  double timeout() const { return timeout_; }
+
+  /// NO_ERROR unless Failed()
+  ErrorCode errorCode() const { return errorCode_; }
+  void setFailed(ErrorCode errorCode, const std::string& reason);
+
+  // client side
+  void Reset() override;
+  bool Failed() const override { return errorCode_ != NO_ERROR || failed_; }
+  std::string ErrorText() const override { return errorText_; }
+  /// only notifies NotifyOnCancel(), the peer is not told
+  void StartCancel() override;
+
+  // server side
+  void SetFailed(const std::string& reason) override;
+  bool IsCanceled() const override { return canceled_; }
+  void NotifyOnCancel(::google::protobuf::Closure* callback) override;
+
+ private:
+  double timeout_;
+  ErrorCode errorCode_;
+  bool failed_;
+  bool canceled_;
+  std::string errorText_;
+  ::google::protobuf::Closure* cancelCallback_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_RPCCONTROLLER_H
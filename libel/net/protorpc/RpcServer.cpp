@@ -14,7 +14,9 @@ using namespace Libel;
 using namespace Libel::net;
 
 RpcServer::RpcServer(EventLoop *loop, const InetAddress &listenAddr)
-: server_(loop, listenAddr, "RpcServer") {
+: server_(loop, listenAddr, "RpcServer"),
+  arenaBlockSize_(0),
+  checksumType_(ProtobufCodecLite::kAdler32) {
   server_.setConnectionCallback(std::bind(&RpcServer::onConnection, this, _1));
 }
 
@@ -34,9 +36,14 @@ void RpcServer::onConnection(const TcpConnectionPtr &connection) {
   if (connection->connected()) {
     RpcChannelPtr channelPtr(new RpcChannel(connection));
     channelPtr->setServices(&services_);
+    channelPtr->setArenaBlockSize(arenaBlockSize_);
+    channelPtr->setChecksumType(checksumType_);
     connection->setMessageCallback(std::bind(&RpcChannel::onMessage, get_pointer(channelPtr), _1, _2, _3));
     connection->setContext(channelPtr);
   } else {
+    RpcChannelPtr channelPtr =
+        std::static_pointer_cast<RpcChannel>(connection->getContext());
+    if (channelPtr) channelPtr->failPendingCalls();
     connection->setContext(RpcChannelPtr());
   }
 }
@@ -5,6 +5,7 @@
 #ifndef LIBEL_RPCSERVER_H
 #define LIBEL_RPCSERVER_H
 
+#include "libel/net/protobuf/ProtobufCodecLite.h"
 #include "libel/net/tcp_server.h"
 
 namespace google {
@@ -29,6 +30,16 @@ public:
 
   void registerService(::google::protobuf::Service*);
 
+  /// RpcChannel::setArenaBlockSize() of every connection, 0 by default
+  void setArenaBlockSize(size_t initialBlockSize) {
+    arenaBlockSize_ = initialBlockSize;
+  }
+
+  /// RpcChannel::setChecksumType() of every connection
+  void setChecksumType(ProtobufCodecLite::ChecksumType type) {
+    checksumType_ = type;
+  }
+
   void start();
 
 private:
@@ -36,6 +47,8 @@ private:
 
   TcpServer server_;
   std::map<std::string, ::google::protobuf::Service*> services_;
+  size_t arenaBlockSize_;
+  ProtobufCodecLite::ChecksumType checksumType_;
 };
 
 }
@@ -100,4 +100,14 @@ void Socket::setKeepAlive(bool on) {
     LOG_ERROR << "failed to set socket SO_KEEPALIVE socket:" << sockfd_ << " error:" << strerror(errno);
 }
 
+bool Socket::setBusyPoll(int microseconds) {
+  int opt_val = microseconds;
+  auto ret = ::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL, &opt_val, static_cast<socklen_t >(sizeof(opt_val)));
+  if (ret < 0) {
+    LOG_ERROR << "failed to set socket SO_BUSY_POLL socket:" << sockfd_ << " error:" << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
 
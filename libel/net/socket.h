@@ -57,6 +57,11 @@ public:
   /// enable/disable SO_KEEPALIVE
   void setKeepAlive(bool on);
 
+  /// SO_BUSY_POLL, recv busy polls the device queue for microseconds
+  /// when no data is there, 0 disables it. Values above
+  /// net.core.busy_read need CAP_NET_ADMIN. false on error.
+  bool setBusyPoll(int microseconds);
+
 private:
   const int sockfd_;
 };
@@ -4,6 +4,7 @@
 
 #include "libel/net/tcp_connection.h"
 
+#include "libel/base/counter.h"
 #include "libel/base/logging.h"
 #include "libel/net/callbacks.h"
 #include "libel/net/channel.h"
@@ -11,11 +12,26 @@
 #include "libel/net/socket.h"
 #include "libel/net/sockets_ops.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 using namespace Libel;
 using namespace Libel::net;
 
+const size_t TcpConnection::kEdgeTriggeredBudget;
+
+namespace {
+
+/// counters are written in loop thread only
+using Util::add;
+using Util::load;
+
+}  // namespace
+
 void Libel::net::defaultConnectionCallback(const TcpConnectionPtr &conn) {
   LOG_TRACE << conn->localAddress().toIpPort() << " -> "
             << conn->peerAddress().toIpPort() << "is"
@@ -40,7 +56,24 @@ TcpConnection::TcpConnection(Libel::net::EventLoop *loop, std::string name,
       localAddr_(localAddr),
       peerAddr_(peerAddr),
       highWaterMark_(64 * 1024 * 1024),
-      context_(nullptr) {
+      lastReceiveTime_(TimeStamp::now()),
+      pendingFileBytes_(0),
+      sendMark_(0),
+      sending_(false),
+      context_(nullptr),
+      bytesRead_(0),
+      bytesWritten_(0),
+      messagesRead_(0),
+      messagesSent_(0),
+      reads_(0),
+      outputQueuedMicroSeconds_(0),
+      outputQueuedSince_(0),
+      highWaterMarks_(0),
+      rttMicroSeconds_(0),
+      rttVarMicroSeconds_(0),
+      totalRetrans_(0),
+      rttSampleTime_(0),
+      rttSampleIntervalMicroSeconds_(TimeStamp::kMicroSecondsPerSecond) {
   assert(loop != nullptr);
   channel_->setReadCallback(std::bind(&TcpConnection::handleRead, this, _1));
   channel_->setWriteCallback(std::bind(&TcpConnection::handleWrite, this));
@@ -55,6 +88,9 @@ TcpConnection::~TcpConnection() {
   LOG_DEBUG << "TcpConnection::dtor[" << name_ << "] at " << this
             << " fd = " << channel_->fd() << " state = " << stateToString();
   assert(state_ == kDisconnected);
+  for (const auto &segment : fileSegments_) {
+    ::close(segment.fd);
+  }
 }
 
 bool TcpConnection::getTcpInfo(struct tcp_info *tcpInfo) const {
@@ -68,6 +104,99 @@ std::string TcpConnection::getTcpInfoString() const {
   return buf;
 }
 
+TcpConnection::Stats TcpConnection::stats() const {
+  Stats stats;
+  stats.bytesRead = load(bytesRead_);
+  stats.bytesWritten = load(bytesWritten_);
+  stats.messagesRead = load(messagesRead_);
+  stats.messagesSent = load(messagesSent_);
+  stats.reads = load(reads_);
+  stats.outputQueuedMicroSeconds = load(outputQueuedMicroSeconds_);
+  const int64_t since = load(outputQueuedSince_);
+  if (since > 0) {
+    stats.outputQueuedMicroSeconds +=
+        std::max<int64_t>(0, TimeStamp::now().microSecondsSinceEpoch() - since);
+  }
+  stats.highWaterMarks = load(highWaterMarks_);
+  stats.rttMicroSeconds = load(rttMicroSeconds_);
+  stats.rttVarMicroSeconds = load(rttVarMicroSeconds_);
+  stats.totalRetrans = load(totalRetrans_);
+  stats.rttSampleTime = load(rttSampleTime_);
+  return stats;
+}
+
+void TcpConnection::setRttSampleInterval(double seconds) {
+  assert(seconds >= 0);
+  rttSampleIntervalMicroSeconds_ =
+      static_cast<int64_t>(seconds * TimeStamp::kMicroSecondsPerSecond);
+}
+
+void TcpConnection::sampleRtt(TimeStamp now) {
+  if (rttSampleIntervalMicroSeconds_ == 0 ||
+      now.microSecondsSinceEpoch() - load(rttSampleTime_) <
+          rttSampleIntervalMicroSeconds_) {
+    return;
+  }
+  struct tcp_info tcpi;
+  if (socket_->getTcpInfo(&tcpi)) {
+    rttMicroSeconds_.store(tcpi.tcpi_rtt, std::memory_order_relaxed);
+    rttVarMicroSeconds_.store(tcpi.tcpi_rttvar, std::memory_order_relaxed);
+    totalRetrans_.store(tcpi.tcpi_total_retrans, std::memory_order_relaxed);
+  }
+  rttSampleTime_.store(now.microSecondsSinceEpoch(),
+                       std::memory_order_relaxed);
+}
+
+void TcpConnection::checkHighWaterMark(size_t oldlen, size_t newlen) {
+  if (newlen >= highWaterMark_ && oldlen < highWaterMark_) {
+    add(highWaterMarks_, 1);
+    if (highWaterMarkCallback_) {
+      loop_->queueInLoop(
+          std::bind(highWaterMarkCallback_, shared_from_this(), newlen));
+    }
+  }
+}
+
+void TcpConnection::countMessage() {
+  if (!sending_) add(messagesSent_, 1);
+}
+
+void TcpConnection::checkAppended() {
+  if (sending_) {
+    const size_t pending = pendingOutputBytes();
+    checkHighWaterMark(sendMark_, pending);
+    sendMark_ = pending;
+  }
+}
+
+void TcpConnection::rebaseSend() {
+  if (sending_) sendMark_ = pendingOutputBytes();
+}
+
+void TcpConnection::startWriting() {
+  if (!channel_->isWriting()) {
+    channel_->enableWriting();
+    if (load(outputQueuedSince_) == 0) {
+      outputQueuedSince_.store(TimeStamp::now().microSecondsSinceEpoch(),
+                               std::memory_order_relaxed);
+    }
+  }
+}
+
+void TcpConnection::stopWriting() {
+  if (channel_->isWriting()) channel_->disableWriting();
+  outputDrained();
+}
+
+void TcpConnection::outputDrained() {
+  const int64_t since = load(outputQueuedSince_);
+  if (since > 0) {
+    add(outputQueuedMicroSeconds_,
+        TimeStamp::now().microSecondsSinceEpoch() - since);
+    outputQueuedSince_.store(0, std::memory_order_relaxed);
+  }
+}
+
 void TcpConnection::send(const void *message, int len) {
   send(std::string(static_cast<const char *>(message), len));
 }
@@ -75,7 +204,9 @@ void TcpConnection::send(const void *message, int len) {
 void TcpConnection::send(const std::string &message) {
   if (state_ == kConnected) {
     if (loop_->isInLoopThread()) {
+      checkAppended();
       sendInLoop(message);
+      rebaseSend();
     } else {
       void (TcpConnection::*fp)(const std::string &message) =
           &TcpConnection::sendInLoop;
@@ -87,8 +218,10 @@ void TcpConnection::send(const std::string &message) {
 void TcpConnection::send(Buffer *message) {
   if (state_ == kConnected) {
     if (loop_->isInLoopThread()) {
+      checkAppended();
       sendInLoop(message->peek(), message->readableBytes());
       message->retrieveAll();
+      rebaseSend();
     } else {
       void (TcpConnection::*fp)(const std::string &message) =
           &TcpConnection::sendInLoop;
@@ -97,6 +230,25 @@ void TcpConnection::send(Buffer *message) {
   }
 }
 
+void TcpConnection::send(const struct iovec *iov, int iovcnt) {
+  if (state_ == kConnected) {
+    if (loop_->isInLoopThread()) {
+      checkAppended();
+      sendInLoop(iov, iovcnt);
+      rebaseSend();
+    } else {
+      std::string message;
+      for (int i = 0; i < iovcnt; ++i) {
+        message.append(static_cast<const char *>(iov[i].iov_base),
+                       iov[i].iov_len);
+      }
+      void (TcpConnection::*fp)(const std::string &message) =
+          &TcpConnection::sendInLoop;
+      loop_->queueInLoop(std::bind(fp, this, std::move(message)));
+    }
+  }
+}
+
 void TcpConnection::sendInLoop(const std::string &message) {
   sendInLoop(message.data(), message.size());
 }
@@ -110,10 +262,13 @@ void TcpConnection::sendInLoop(const void *message, size_t len) {
     LOG_WARN << "disconnected, give up writing";
     return;
   }
+  countMessage();
   /// if nothing in output queue, try writing data directly
-  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
+  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0 &&
+      fileSegments_.empty()) {
     nwrote = sockets::write(channel_->fd(), message, len);
     if (nwrote >= 0) {
+      add(bytesWritten_, nwrote);
       remaining = len - nwrote;
       if (remaining == 0 && writeCompleteCallback_)
         loop_->queueInLoop(
@@ -129,15 +284,222 @@ void TcpConnection::sendInLoop(const void *message, size_t len) {
   }
   assert(remaining <= len);
   if (!fatalError && remaining > 0) {
+    size_t oldlen = pendingOutputBytes();
+    checkHighWaterMark(oldlen, oldlen + remaining);
+    tailOutputBuffer()->append(static_cast<const char *>(message) + nwrote,
+                               remaining);
+    startWriting();
+  }
+}
+
+void TcpConnection::sendInLoop(const struct iovec *iov, int iovcnt) {
+  loop_->assertInLoopThread();
+  if (state_ == kDisconnected) {
+    LOG_WARN << "disconnected, give up writing";
+    return;
+  }
+  countMessage();
+  if (!fileSegments_.empty()) {
+    /// can't be written before queued files
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; ++i) len += iov[i].iov_len;
+    size_t oldlen = pendingOutputBytes();
+    checkHighWaterMark(oldlen, oldlen + len);
+    for (int i = 0; i < iovcnt; ++i) {
+      tailOutputBuffer()->append(iov[i].iov_base, iov[i].iov_len);
+    }
+    return;
+  }
+  const int kMaxIov = 64;
+  struct iovec vec[kMaxIov];
+  int cnt = 0;
+  /// pending bytes go first to keep the order of output stream
+  const size_t pending = outputBuffer_.readableBytes();
+  if (pending > 0) {
+    vec[cnt].iov_base = const_cast<char *>(outputBuffer_.peek());
+    vec[cnt].iov_len = pending;
+    ++cnt;
+  }
+  size_t len = 0;
+  for (int i = 0; i < iovcnt; ++i) {
+    len += iov[i].iov_len;
+    /// segments beyond kMaxIov are left for handleWrite
+    if (cnt < kMaxIov) vec[cnt++] = iov[i];
+  }
+  if (cnt == 0) return;
+
+  size_t written = 0;
+  bool fatalError = false;
+  ssize_t nwrote = sockets::writev(channel_->fd(), vec, cnt);
+  if (nwrote >= 0) {
+    written = implicit_cast<size_t>(nwrote);
+    add(bytesWritten_, nwrote);
+  } else if (errno != EWOULDBLOCK) {
+    LOG_ERROR << " failed to call writev in TcpConnection::sendInLoop";
+    if (errno == EPIPE || errno == ECONNRESET)  // FIXME: any other?
+      fatalError = true;
+  }
+  if (fatalError) return;
+
+  const size_t fromOutput = std::min(written, pending);
+  outputBuffer_.retrieve(fromOutput);
+  written -= fromOutput;
+  assert(written <= len);
+  const size_t remaining = len - written;
+  if (remaining > 0) {
     size_t oldlen = outputBuffer_.readableBytes();
-    if (oldlen + remaining >= highWaterMark_ && oldlen < highWaterMark_ &&
-        highWaterMarkCallback_) {
-      loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(),
-                                   oldlen + remaining));
+    checkHighWaterMark(oldlen, oldlen + remaining);
+    /// copy only the unsent tail
+    for (int i = 0; i < iovcnt; ++i) {
+      size_t skip = std::min(written, iov[i].iov_len);
+      written -= skip;
+      outputBuffer_.append(static_cast<const char *>(iov[i].iov_base) + skip,
+                           iov[i].iov_len - skip);
     }
-    outputBuffer_.append(static_cast<const char *>(message) + nwrote,
-                         remaining);
-    if (!channel_->isWriting()) channel_->enableWriting();
+  }
+  /// pending bytes may be left even when all of iov is, e.g. iov sums to 0
+  if (outputBuffer_.readableBytes() > 0) {
+    startWriting();
+  } else {
+    stopWriting();
+    if (writeCompleteCallback_)
+      loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+    if (state_ == kDisconnecting) shutdownInLoop();
+  }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length) {
+  if (state_ == kConnected && length > 0) {
+    int dupFd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dupFd < 0) {
+      LOG_ERROR << "failed to dup fd = " << fd
+                << " in TcpConnection::sendFile error:" << strerror(errno);
+      return;
+    }
+    loop_->runInLoop(std::bind(&TcpConnection::sendFileInLoop, this, dupFd,
+                               offset, length));
+  }
+}
+
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t length) {
+  loop_->assertInLoopThread();
+  if (state_ == kDisconnected) {
+    LOG_WARN << "disconnected, give up sending file";
+    ::close(fd);
+    return;
+  }
+  countMessage();
+  checkAppended();
+  size_t oldlen = pendingOutputBytes();
+  checkHighWaterMark(oldlen, oldlen + length);
+  FileSegment segment = {fd, offset, length, Buffer()};
+  fileSegments_.push_back(std::move(segment));
+  pendingFileBytes_ += length;
+  if (!channel_->isWriting()) {
+    /// nothing ahead of the file, try sending right now
+    if (drainOutput()) {
+      if (writeCompleteCallback_)
+        loop_->queueInLoop(
+            std::bind(writeCompleteCallback_, shared_from_this()));
+      if (state_ == kDisconnecting) shutdownInLoop();
+    } else if (state_ != kDisconnected) {
+      startWriting();
+    }
+  }
+  rebaseSend();
+}
+
+Buffer *TcpConnection::beginSend() {
+  loop_->assertInLoopThread();
+  sendMark_ = pendingOutputBytes();
+  sending_ = true;
+  if (state_ != kConnected) {
+    LOG_WARN << "not connected, give up writing";
+    return nullptr;
+  }
+  return tailOutputBuffer();
+}
+
+void TcpConnection::endSend() {
+  loop_->assertInLoopThread();
+  sending_ = false;
+  const size_t pending = pendingOutputBytes();
+  if (state_ != kConnected) {
+    /// e.g. shutdown() in between, the write side may be closed already
+    const size_t appended = pending > sendMark_ ? pending - sendMark_ : 0;
+    Buffer *output = tailOutputBuffer();
+    output->unwrite(std::min(appended, output->readableBytes()));
+    return;
+  }
+  add(messagesSent_, 1);
+  checkHighWaterMark(sendMark_, pending);
+  if (!channel_->isWriting() && pending > 0) {
+    if (drainOutput()) {
+      if (writeCompleteCallback_)
+        loop_->queueInLoop(
+            std::bind(writeCompleteCallback_, shared_from_this()));
+      if (state_ == kDisconnecting) shutdownInLoop();
+    } else if (state_ != kDisconnected) {
+      startWriting();
+    }
+  }
+}
+
+size_t TcpConnection::pendingOutputBytes() const {
+  size_t pending = outputBuffer_.readableBytes() + pendingFileBytes_;
+  for (const auto &segment : fileSegments_) {
+    pending += segment.trailer.readableBytes();
+  }
+  return pending;
+}
+
+Buffer *TcpConnection::tailOutputBuffer() {
+  return fileSegments_.empty() ? &outputBuffer_ : &fileSegments_.back().trailer;
+}
+
+bool TcpConnection::drainOutput(size_t budget) {
+  while (true) {
+    if (outputBuffer_.readableBytes() > 0) {
+      if (budget == 0) return false;
+      ssize_t n = sockets::write(
+          channel_->fd(), outputBuffer_.peek(),
+          std::min(outputBuffer_.readableBytes(), budget));
+      if (n > 0) {
+        add(bytesWritten_, n);
+        outputBuffer_.retrieve(n);
+        budget -= n;
+        if (outputBuffer_.readableBytes() > 0) return false;
+      } else {
+        if (errno != EWOULDBLOCK) LOG_ERROR << " failed to call write";
+        return false;
+      }
+    }
+    if (fileSegments_.empty()) return true;
+    if (budget == 0) return false;
+
+    FileSegment &segment = fileSegments_.front();
+    ssize_t n = sockets::sendfile(channel_->fd(), segment.fd, &segment.offset,
+                                  std::min(segment.remaining, budget));
+    if (n > 0) {
+      add(bytesWritten_, n);
+      segment.remaining -= n;
+      pendingFileBytes_ -= n;
+      budget -= n;
+      if (segment.remaining > 0) return false;
+    } else if (n < 0 && errno == EWOULDBLOCK) {
+      return false;
+    } else {
+      /// file shorter than promised or sendfile failed,
+      /// the stream is broken, peer can't make sense of it anymore.
+      LOG_ERROR << "failed to call sendfile in TcpConnection::drainOutput "
+                << (n == 0 ? "unexpected EOF" : strerror(errno));
+      if (state_ == kConnected || state_ == kDisconnecting) handleClose();
+      return false;
+    }
+    /// bytes sent after this file are next
+    ::close(segment.fd);
+    outputBuffer_.swap(segment.trailer);
+    fileSegments_.pop_front();
   }
 }
 
@@ -197,6 +559,15 @@ const char *TcpConnection::stateToString() const {
 
 void TcpConnection::setTcpNoDelay(bool on) { socket_->setTcpNoDelay(on); }
 
+bool TcpConnection::setBusyPoll(int microseconds) {
+  return socket_->setBusyPoll(microseconds);
+}
+
+void TcpConnection::setEdgeTriggered(bool on) {
+  assert(state_ == kConnecting);
+  channel_->setEdgeTriggered(on && loop_->supportsEdgeTriggered());
+}
+
 void TcpConnection::startRead() {
   loop_->runInLoop(std::bind(&TcpConnection::startReadInLoop, this));
 }
@@ -244,9 +615,18 @@ void TcpConnection::connectDestroyed() {
 
 void TcpConnection::handleRead(Libel::TimeStamp receiveTime) {
   loop_->assertInLoopThread();
+  if (channel_->edgeTriggered()) {
+    handleReadEdgeTriggered(receiveTime);
+    return;
+  }
+  add(reads_, 1);
+  sampleRtt(receiveTime);
   int savedErrno = 0;
   ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
   if (n > 0) {
+    lastReceiveTime_ = receiveTime;
+    add(bytesRead_, n);
+    add(messagesRead_, 1);
     messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
   } else if (n == 0) {
     handleClose();
@@ -257,24 +637,70 @@ void TcpConnection::handleRead(Libel::TimeStamp receiveTime) {
   }
 }
 
+void TcpConnection::handleReadEdgeTriggered(Libel::TimeStamp receiveTime) {
+  add(reads_, 1);
+  sampleRtt(receiveTime);
+  size_t budget = kEdgeTriggeredBudget;
+  while (true) {
+    int savedErrno = 0;
+    ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    if (n > 0) {
+      lastReceiveTime_ = receiveTime;
+      add(bytesRead_, n);
+      add(messagesRead_, 1);
+      messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+      if (state_ == kDisconnected || !reading_) return;
+      if (implicit_cast<size_t>(n) >= budget) {
+        /// no new edge for bytes left in socket, come back by ourselves
+        loop_->queueInLoop(
+            std::bind(&TcpConnection::resumeRead, shared_from_this()));
+        return;
+      }
+      budget -= n;
+    } else if (n == 0) {
+      handleClose();
+      return;
+    } else {
+      if (savedErrno == EAGAIN) return;
+      errno = savedErrno;
+      LOG_ERROR << "failed to read message TcpConnection::handleRead";
+      handleError();
+      return;
+    }
+  }
+}
+
+void TcpConnection::resumeRead() {
+  loop_->assertInLoopThread();
+  if ((state_ == kConnected || state_ == kDisconnecting) && reading_) {
+    handleReadEdgeTriggered(TimeStamp::now());
+  }
+}
+
 void TcpConnection::handleWrite() {
   loop_->assertInLoopThread();
   if (channel_->isWriting()) {
-    ssize_t n = sockets::write(channel_->fd(), outputBuffer_.peek(),
-                               outputBuffer_.readableBytes());
-    if (n > 0) {
-      outputBuffer_.retrieve(n);
-      if (outputBuffer_.readableBytes() == 0) {
-        channel_->disableWriting();
-        if (writeCompleteCallback_)
+    sampleRtt(loop_->pollReturnTime());
+    if (!channel_->edgeTriggered()) {
+      if (!drainOutput()) return;
+    } else {
+      const size_t pending = pendingOutputBytes();
+      if (!drainOutput(kEdgeTriggeredBudget)) {
+        if (state_ != kDisconnected &&
+            pending - pendingOutputBytes() >= kEdgeTriggeredBudget) {
+          /// stopped by budget, not by EAGAIN, no edge will come
           loop_->queueInLoop(
-              std::bind(writeCompleteCallback_, shared_from_this()));
-        if (state_ == kDisconnecting) shutdownInLoop();
+              std::bind(&TcpConnection::handleWrite, shared_from_this()));
+        }
+        return;
       }
-    } else {
-      LOG_ERROR << " failed to call write";
     }
-  } else {
+    stopWriting();
+    if (writeCompleteCallback_)
+      loop_->queueInLoop(
+          std::bind(writeCompleteCallback_, shared_from_this()));
+    if (state_ == kDisconnecting) shutdownInLoop();
+  } else if (!channel_->edgeTriggered()) {
     LOG_TRACE << " Connection fd = " << channel_->fd()
               << " is down, no more writing";
   }
@@ -286,6 +712,7 @@ void TcpConnection::handleClose() {
   assert(state_ == kConnected || state_ == kDisconnecting);
   setState(kDisconnected);
   channel_->disableAll();
+  outputDrained();
 
   TcpConnectionPtr guardThis(shared_from_this());
   connectionCallback_(guardThis);
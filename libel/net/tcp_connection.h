@@ -10,11 +10,18 @@
 #include "libel/net/callbacks.h"
 #include "libel/net/inet_address.h"
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
 
+#include <sys/types.h>
+
 /// forward declaration
 /// struct tcp_info is in <netinet/tcp.h>
 struct tcp_info;
+/// struct iovec is in <sys/uio.h>
+struct iovec;
 
 namespace Libel {
 
@@ -31,6 +38,25 @@ class Socket;
 class TcpConnection : noncopyable,
                       public std::enable_shared_from_this<TcpConnection> {
  public:
+  /// counters since creation, written in loop thread,
+  /// readable from any thread
+  struct Stats {
+    int64_t bytesRead;
+    int64_t bytesWritten;     // to socket, sendfile(2) included
+    int64_t messagesRead;     // calls of message callback
+    int64_t messagesSent;     // send() and sendFile() in loop thread
+    int64_t reads;            // readable events handled
+    /// time output stayed queued in user space, the current stretch
+    /// included, large for peers that don't keep up with us
+    int64_t outputQueuedMicroSeconds;
+    int64_t highWaterMarks;   // times pending output crossed the mark
+    /// from the last tcp_info sample, see setRttSampleInterval()
+    int64_t rttMicroSeconds;
+    int64_t rttVarMicroSeconds;
+    int64_t totalRetrans;
+    int64_t rttSampleTime;    // microseconds since epoch, 0 if none
+  };
+
   /// Constructs a TcpConnection with a connected sockfd
   ///
   /// User should not create this object
@@ -44,17 +70,63 @@ class TcpConnection : noncopyable,
   const InetAddress& peerAddress() const { return peerAddr_; }
   bool connected() const { return state_ == kConnected; }
   bool disconnected() const { return state_ == kDisconnected; }
+  /// when the last bytes were read, creation time if none yet.
+  /// in loop thread
+  TimeStamp lastReceiveTime() const { return lastReceiveTime_; }
   // return true if success
   bool getTcpInfo(struct tcp_info*) const;
   std::string getTcpInfoString() const;
+  /// thread safe
+  Stats stats() const;
+  /// tcp_info is sampled for Stats on reading or writing, at most once
+  /// per interval, 1 second by default, 0 disables it. In loop thread.
+  void setRttSampleInterval(double seconds);
 
   void send(const void* message, int len);
   void send(const std::string& message);
   void send(Buffer* message);  // this one will swap data
+  /// gather-write of several segments, e.g. header and body.
+  ///
+  /// in loop thread, segments and pending output are written with one
+  /// writev, only the unsent tail is copied into output buffer.
+  /// in other threads, segments are copied before queued to loop.
+  void send(const struct iovec* iov, int iovcnt);
+  /// zero-copy transmission of length bytes of fd starting at offset.
+  ///
+  /// the file segment is queued in order with buffered bytes and
+  /// drained with sendfile(2) when socket is writable.
+  /// fd is duplicated, so caller can close it right after this call.
+  void sendFile(int fd, off_t offset, size_t length);
+  /// Writes a message in place, without the copy out of a temporary
+  /// buffer. In loop thread:
+  ///   Buffer* output = conn->beginSend();
+  ///   output->append(...);
+  ///   conn->endSend();
+  /// send() may be called in between, it writes out what is appended so
+  /// far first. It is part of the same message, counted once by
+  /// endSend(), and the high water mark is checked once for each byte.
+  /// sendFile() in between moves the end of output stream, call
+  /// beginSend() again after it.
+  /// nullptr if not connected, e.g. after shutdown().
+  Buffer* beginSend();
+  /// sends what was appended since beginSend(), drops it instead if the
+  /// connection is no longer connected
+  void endSend();
   void shutdown();             // NOT thread safe, but no simultaneous calling
   void forceClose();
   void forceCloseWithDelay(double seconds);
   void setTcpNoDelay(bool on);
+  /// Socket::setBusyPoll(), false on error
+  bool setBusyPoll(int microseconds);
+  /// Edge triggered epoll for this connection, before connectEstablished(),
+  /// TcpServer::setEdgeTriggered() does it for every connection.
+  /// Ignored if the loop doesn't EventLoop::supportsEdgeTriggered().
+  ///
+  /// Reading and writing go on until EAGAIN, at most
+  /// kEdgeTriggeredBudget bytes each per event, the rest is resumed at
+  /// the end of the loop iteration, after other channels had their turn.
+  void setEdgeTriggered(bool on);
+  static const size_t kEdgeTriggeredBudget = 256 * 1024;
   void startRead();
   void stopRead();
   bool isReading() const {
@@ -95,18 +167,45 @@ class TcpConnection : noncopyable,
 
   Buffer* outputBuffer() { return &outputBuffer_; }
 
+  /// bytes not yet written to socket, including queued file segments
+  size_t pendingOutputBytes() const;
+
  private:
   enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };
   void handleRead(TimeStamp receiveTime);
+  void handleReadEdgeTriggered(TimeStamp receiveTime);
+  /// queued when the read budget runs out
+  void resumeRead();
   void handleWrite();
   void handleClose();
   void handleError();
   void sendInLoop(const std::string& message);
   void sendInLoop(const void* message, size_t len);
+  void sendInLoop(const struct iovec* iov, int iovcnt);
+  void sendFileInLoop(int fd, off_t offset, size_t length);
+  /// where newly sent bytes go, after the last queued file segment
+  Buffer* tailOutputBuffer();
+  /// writes output buffer and file segments until EAGAIN or budget
+  /// bytes, returns true if everything is written.
+  bool drainOutput(size_t budget = SIZE_MAX);
   void shutdownInLoop();
   void forceCloseInLoop();
   void setState(StateE s) { state_ = s; }
   const char* stateToString() const;
+  /// counts the crossing and calls highWaterMarkCallback_
+  void checkHighWaterMark(size_t oldlen, size_t newlen);
+  /// a send() between beginSend() and endSend() is part of that message
+  void countMessage();
+  /// Between beginSend() and endSend(), before a send() queues more,
+  /// checks the high water mark for what was appended since sendMark_.
+  void checkAppended();
+  /// after that send(), endSend() checks from here on
+  void rebaseSend();
+  /// enable/disableWriting(), timing how long output stays queued
+  void startWriting();
+  void stopWriting();
+  void outputDrained();
+  void sampleRtt(TimeStamp now);
   void startReadInLoop();
   void stopReadInLoop();
 
@@ -125,9 +224,40 @@ class TcpConnection : noncopyable,
   HighWaterMarkCallback highWaterMarkCallback_;
   CloseCallback closeCallback_;
   size_t highWaterMark_;
+  TimeStamp lastReceiveTime_;
   Buffer inputBuffer_;
   Buffer outputBuffer_;
+
+  /// a file to be sent with sendfile, trailer holds bytes sent after it
+  struct FileSegment {
+    int fd;
+    off_t offset;
+    size_t remaining;
+    Buffer trailer;
+  };
+  /// output stream is outputBuffer_, then each file and its trailer
+  std::deque<FileSegment> fileSegments_;
+  size_t pendingFileBytes_;
+  /// pendingOutputBytes() at beginSend(), or after the last send() or
+  /// sendFile() between beginSend() and endSend()
+  size_t sendMark_;
+  bool sending_;
   std::shared_ptr<void> context_;
+
+  std::atomic<int64_t> bytesRead_;
+  std::atomic<int64_t> bytesWritten_;
+  std::atomic<int64_t> messagesRead_;
+  std::atomic<int64_t> messagesSent_;
+  std::atomic<int64_t> reads_;
+  std::atomic<int64_t> outputQueuedMicroSeconds_;
+  /// microseconds since epoch, 0 if nothing queued
+  std::atomic<int64_t> outputQueuedSince_;
+  std::atomic<int64_t> highWaterMarks_;
+  std::atomic<int64_t> rttMicroSeconds_;
+  std::atomic<int64_t> rttVarMicroSeconds_;
+  std::atomic<int64_t> totalRetrans_;
+  std::atomic<int64_t> rttSampleTime_;
+  int64_t rttSampleIntervalMicroSeconds_;
 };
 
 }  // namespace net
@@ -4,12 +4,17 @@
 
 #include "libel/net/tcp_server.h"
 
+#include "libel/base/Mutex.h"
+#include "libel/base/countdown_latch.h"
 #include "libel/base/logging.h"
 #include "libel/net/acceptor.h"
 #include "libel/net/eventloop.h"
 #include "libel/net/eventloop_threadpool.h"
+#include "libel/net/idle_reaper.h"
+#include "libel/net/loop_selector.h"
 #include "libel/net/sockets_ops.h"
 
+#include <algorithm>
 #include <cstdio>
 
 using namespace Libel;
@@ -19,14 +24,20 @@ TcpServer::TcpServer(Libel::net::EventLoop *loop,
                      const Libel::net::InetAddress &listenAddr,
                      std::string nameArg, Libel::net::TcpServer::Option option)
     : loop_(loop),
+      listenAddr_(listenAddr),
+      option_(option),
       ipPort_(listenAddr.toIpPort()),
       name_(std::move(nameArg)),
-      acceptor_(new Acceptor(loop_, listenAddr, option == kReusePort)),
+      acceptor_(new Acceptor(loop_, listenAddr, option != kNoReusePort)),
       threadPool_(new EventLoopThreadPool(loop_, name_)),
       connectionCallback_(defaultConnectionCallback),
       messageCallback_(defaultMessageCallback),
       started_(ATOMIC_FLAG_INIT),
-      nextConnId_(1) {
+      nextConnId_(1),
+      idleSeconds_(0),
+      edgeTriggered_(false),
+      socketBusyPollMicroSeconds_(0),
+      rttSampleInterval_(1.0) {
   acceptor_->setNewConnectionCallback(
       std::bind(&TcpServer::newConnection, this, _1, _2));
   started_.clear();
@@ -42,6 +53,18 @@ TcpServer::~TcpServer() {
     conn->getLoop()->runInLoop(
         std::bind(&TcpConnection::connectDestroyed, conn));
   }
+  if (!loopAcceptors_.empty()) {
+    /// waits, so that no IO loop calls back into this after destruction
+    CountDownLatch latch(static_cast<int>(loopAcceptors_.size()));
+    for (auto &item : loopAcceptors_) {
+      item.first->runInLoop(std::bind(&TcpServer::stopLoopAcceptorInLoop, this,
+                                      get_pointer(item.second), &latch));
+    }
+    latch.wait();
+  }
+  for (auto &item : idleReapers_) {
+    item.second->stop();
+  }
 }
 
 void TcpServer::setThreadNum(int numTheads) {
@@ -49,21 +72,55 @@ void TcpServer::setThreadNum(int numTheads) {
   threadPool_->setThreadNum(numTheads);
 }
 
+void TcpServer::setLoopSelector(std::unique_ptr<LoopSelector> selector) {
+  threadPool_->setLoopSelector(std::move(selector));
+}
+
 void TcpServer::start() {
   if (!started_.test_and_set()) {
     threadPool_->start(threadInitCallback_);
     assert(!acceptor_->isListening());
-    loop_->runInLoop(std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+    std::vector<EventLoop *> ioLoops = threadPool_->getAllLoops();
+    if (option_ == kReusePortPerLoop && ioLoops.front() != loop_) {
+      /// acceptor_ stays bound but never listens, so the kernel only
+      /// hands connections to the IO loops
+      for (EventLoop *ioLoop : ioLoops) {
+        std::unique_ptr<LoopAcceptor> &loopAcceptor = loopAcceptors_[ioLoop];
+        loopAcceptor.reset(new LoopAcceptor);
+        loopAcceptor->acceptor.reset(new Acceptor(ioLoop, listenAddr_, true));
+        loopAcceptor->acceptor->setAcceptBatch(acceptor_->acceptBatch());
+        loopAcceptor->acceptor->setNewConnectionCallback(std::bind(
+            &TcpServer::newConnectionInLoop, this, ioLoop, _1, _2));
+        if (idleSeconds_ > 0) {
+          idleReaperOf(ioLoop);
+        }
+      }
+      for (auto &item : loopAcceptors_) {
+        item.first->runInLoop(std::bind(
+            &Acceptor::listen, get_pointer(item.second->acceptor)));
+      }
+    } else {
+      loop_->runInLoop(std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+    }
   }
 }
 
-void TcpServer::newConnection(int sockfd,
-                              const Libel::net::InetAddress &peerAddr) {
-  loop_->assertInLoopThread();
-  auto ioLoop = threadPool_->getNextLoop();
+Acceptor::Stats TcpServer::acceptStats() const {
+  Acceptor::Stats total = acceptor_->stats();
+  /// loopAcceptors_ is read only once started
+  for (auto &item : loopAcceptors_) {
+    Acceptor::Stats stats = item.second->acceptor->stats();
+    total.accepted += stats.accepted;
+    total.wakeups += stats.wakeups;
+    total.emfile += stats.emfile;
+  }
+  return total;
+}
+
+TcpConnectionPtr TcpServer::createConnection(
+    EventLoop *ioLoop, int sockfd, const Libel::net::InetAddress &peerAddr) {
   char buf[64] = {};
-  snprintf(buf, sizeof(buf), "-%s#%d", ipPort_.c_str(), nextConnId_);
-  ++nextConnId_;
+  snprintf(buf, sizeof(buf), "-%s#%d", ipPort_.c_str(), nextConnId_++);
   std::string connName = name_ + buf;
 
   LOG_INFO << "TcpServer::newConnection [" << name_ << "] - new connection ["
@@ -71,16 +128,73 @@ void TcpServer::newConnection(int sockfd,
   InetAddress localAddr(sockets::getLocalAddr(sockfd));
   TcpConnectionPtr conn(
       new TcpConnection(ioLoop, connName, sockfd, localAddr, peerAddr));
-  connections_[connName] = conn;
   conn->setConnectionCallback(connectionCallback_);
   conn->setMessageCallback(messageCallback_);
   conn->setWriteCompleteCallback(writeCompleteCallback_);
   conn->setCloseCallback(std::bind(&TcpServer::removeConnection, this, _1));
+  if (edgeTriggered_) {
+    conn->setEdgeTriggered(true);
+  }
+  if (socketBusyPollMicroSeconds_ > 0) {
+    conn->setBusyPoll(socketBusyPollMicroSeconds_);
+  }
+  conn->setRttSampleInterval(rttSampleInterval_);
+  if (LoopSelector *selector = threadPool_->loopSelector()) {
+    selector->connectionAdded(ioLoop);
+  }
+  return conn;
+}
+
+void TcpServer::newConnection(int sockfd,
+                              const Libel::net::InetAddress &peerAddr) {
+  loop_->assertInLoopThread();
+  auto ioLoop = threadPool_->getLoopFor(peerAddr);
+  TcpConnectionPtr conn(createConnection(ioLoop, sockfd, peerAddr));
+  connections_[conn->name()] = conn;
   ioLoop->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
+  if (idleSeconds_ > 0) {
+    ioLoop->runInLoop(std::bind(&IdleReaper::add, idleReaperOf(ioLoop), conn));
+  }
+}
+
+void TcpServer::newConnectionInLoop(EventLoop *ioLoop, int sockfd,
+                                    const Libel::net::InetAddress &peerAddr) {
+  ioLoop->assertInLoopThread();
+  TcpConnectionPtr conn(createConnection(ioLoop, sockfd, peerAddr));
+  loopAcceptors_.at(ioLoop)->connections[conn->name()] = conn;
+  conn->connectEstablished();
+  if (idleSeconds_ > 0) {
+    idleReapers_.at(ioLoop)->add(conn);
+  }
+}
+
+std::shared_ptr<IdleReaper> TcpServer::idleReaperOf(EventLoop *ioLoop) {
+  loop_->assertInLoopThread();
+  std::shared_ptr<IdleReaper> &reaper = idleReapers_[ioLoop];
+  if (!reaper) {
+    reaper = std::make_shared<IdleReaper>(ioLoop, idleSeconds_);
+    reaper->start();
+  }
+  return reaper;
 }
 
 void TcpServer::removeConnection(const Libel::net::TcpConnectionPtr &conn) {
-  loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+  if (loopAcceptors_.empty()) {
+    loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+    return;
+  }
+  /// accepted by its own IO loop, which is calling us
+  auto ioLoop = conn->getLoop();
+  ioLoop->assertInLoopThread();
+  LOG_INFO << "TcpServer::removeConnection [" << name_ << "] - connection"
+           << conn->name();
+  size_t n = loopAcceptors_.at(ioLoop)->connections.erase(conn->name());
+  (void)n;
+  assert(n == 1);
+  if (LoopSelector *selector = threadPool_->loopSelector()) {
+    selector->connectionRemoved(ioLoop);
+  }
+  ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
 }
 
 void TcpServer::removeConnectionInLoop(
@@ -92,5 +206,94 @@ void TcpServer::removeConnectionInLoop(
   (void)n;
   assert(n == 1);
   auto ioLoop = conn->getLoop();
+  if (LoopSelector *selector = threadPool_->loopSelector()) {
+    selector->connectionRemoved(ioLoop);
+  }
   ioLoop->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
 }
+
+void TcpServer::stopLoopAcceptorInLoop(LoopAcceptor *loopAcceptor,
+                                       CountDownLatch *latch) {
+  loopAcceptor->acceptor.reset();
+  for (auto &item : loopAcceptor->connections) {
+    item.second->connectDestroyed();
+  }
+  loopAcceptor->connections.clear();
+  latch->countDown();
+}
+
+struct TcpServer::StatsCollector {
+  explicit StatsCollector(StatsCallback callback, int loops)
+      : cb(std::move(callback)), remaining(loops) {
+    memZero(&snapshot.total, sizeof(snapshot.total));
+  }
+
+  StatsCallback cb;
+  MutexLock mutex;
+  StatsSnapshot snapshot GUARDED_BY(mutex);
+  int remaining GUARDED_BY(mutex);
+};
+
+void TcpServer::collectStats(StatsCallback cb) {
+  if (loopAcceptors_.empty()) {
+    loop_->runInLoop(
+        std::bind(&TcpServer::collectStatsInLoop, this, std::move(cb)));
+    return;
+  }
+  /// loopAcceptors_ is read only once started
+  auto collector = std::make_shared<StatsCollector>(
+      std::move(cb), static_cast<int>(loopAcceptors_.size()));
+  for (auto &item : loopAcceptors_) {
+    item.first->runInLoop(std::bind(&TcpServer::collectLoopStatsInLoop, this,
+                                    get_pointer(item.second), collector));
+  }
+}
+
+void TcpServer::addStats(const ConnectionMap &connections,
+                         StatsSnapshot *snapshot) {
+  TcpConnection::Stats &total = snapshot->total;
+  for (const auto &item : connections) {
+    const TcpConnectionPtr &conn = item.second;
+    ConnectionStats entry = {conn->name(), conn->peerAddress(), conn->stats()};
+    const TcpConnection::Stats &stats = entry.stats;
+    total.bytesRead += stats.bytesRead;
+    total.bytesWritten += stats.bytesWritten;
+    total.messagesRead += stats.messagesRead;
+    total.messagesSent += stats.messagesSent;
+    total.reads += stats.reads;
+    total.outputQueuedMicroSeconds += stats.outputQueuedMicroSeconds;
+    total.highWaterMarks += stats.highWaterMarks;
+    total.rttMicroSeconds = std::max(total.rttMicroSeconds,
+                                     stats.rttMicroSeconds);
+    total.rttVarMicroSeconds = std::max(total.rttVarMicroSeconds,
+                                        stats.rttVarMicroSeconds);
+    total.totalRetrans += stats.totalRetrans;
+    total.rttSampleTime = std::max(total.rttSampleTime, stats.rttSampleTime);
+    snapshot->connections.push_back(std::move(entry));
+  }
+}
+
+void TcpServer::collectStatsInLoop(StatsCallback cb) {
+  loop_->assertInLoopThread();
+  StatsSnapshot snapshot;
+  memZero(&snapshot.total, sizeof(snapshot.total));
+  snapshot.connections.reserve(connections_.size());
+  addStats(connections_, &snapshot);
+  cb(snapshot);
+}
+
+void TcpServer::collectLoopStatsInLoop(
+    LoopAcceptor *loopAcceptor,
+    const std::shared_ptr<StatsCollector> &collector) {
+  StatsSnapshot snapshot;
+  bool last = false;
+  {
+    MutexLockGuard lock(collector->mutex);
+    addStats(loopAcceptor->connections, &collector->snapshot);
+    last = --collector->remaining == 0;
+    if (last) snapshot = std::move(collector->snapshot);
+  }
+  if (last) {
+    collector->cb(snapshot);
+  }
+}
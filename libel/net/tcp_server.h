@@ -5,19 +5,24 @@
 #ifndef LIBEL_TCP_SERVER_H
 #define LIBEL_TCP_SERVER_H
 
+#include "libel/net/acceptor.h"
 #include "libel/net/callbacks.h"
 #include "libel/net/tcp_connection.h"
 
 #include <atomic>
 #include <map>
+#include <vector>
 
 namespace Libel {
 
+class CountDownLatch;
+
 namespace net {
 
-class Acceptor;
 class EventLoop;
 class EventLoopThreadPool;
+class IdleReaper;
+class LoopSelector;
 
 ///
 /// Tcp server, supports single-threaded and thread-pool models.
@@ -26,9 +31,26 @@ class TcpServer : noncopyable {
  public:
   using ThreadInitCallback = std::function<void(EventLoop*)>;
 
+  struct ConnectionStats {
+    std::string name;
+    InetAddress peerAddr;
+    TcpConnection::Stats stats;
+  };
+  struct StatsSnapshot {
+    /// counters summed over connections, rtt fields are the largest
+    TcpConnection::Stats total;
+    std::vector<ConnectionStats> connections;
+  };
+  using StatsCallback = std::function<void(const StatsSnapshot&)>;
+
   enum Option {
     kNoReusePort,
     kReusePort,
+    /// Every IO loop owns an Acceptor bound with SO_REUSEPORT, the
+    /// kernel spreads incoming connections and each loop accepts and
+    /// serves its own, without going through the base loop.
+    /// listenAddr must have a fixed port.
+    kReusePortPerLoop,
   };
 
   TcpServer(EventLoop* loop, const InetAddress& listenAddr,
@@ -48,8 +70,14 @@ class TcpServer : noncopyable {
   /// this is the default value.
   /// - 1 means all I/O in another thread.
   /// - N means a thread pool with N thread, new connections
-  /// are all assigned on a round-robin basis.
+  /// are assigned on a round-robin basis, unless setLoopSelector().
   void setThreadNum(int numTheads);
+
+  /// Chooses the IO loop of each new connection, see LoopSelector,
+  /// e.g. setLoopSelector(LoopSelector::newLeastConnections()).
+  /// Not used in kReusePortPerLoop, where the kernel chooses.
+  /// Must be called before @func start
+  void setLoopSelector(std::unique_ptr<LoopSelector> selector);
   void setThreadInitCallback(ThreadInitCallback cb) {
     threadInitCallback_ = std::move(cb);
   }
@@ -80,16 +108,90 @@ class TcpServer : noncopyable {
     writeCompleteCallback_ = std::move(cb);
   }
 
+  /// Force closes connections which have read nothing for seconds.
+  ///
+  /// Each IO loop keeps its connections in a wheel of one-second
+  /// buckets, refreshed for free on every read, no timer per connection.
+  /// Must be called before @func start, 0 disables it, the default.
+  void setIdleTimeout(int seconds) {
+    assert(seconds >= 0);
+    idleSeconds_ = seconds;
+  }
+
+  /// Serves connections with edge triggered epoll, see
+  /// TcpConnection::setEdgeTriggered(). Must be called before @func start
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+
+  /// SO_BUSY_POLL for every connection, see Socket::setBusyPoll(),
+  /// goes along with EventLoop::setBusyPoll() of IO loops.
+  /// Must be called before @func start, 0 leaves sockets alone, the default.
+  void setSocketBusyPoll(int microseconds) {
+    assert(microseconds >= 0);
+    socketBusyPollMicroSeconds_ = microseconds;
+  }
+
+  /// At most batch connections are accepted per readable event of the
+  /// listening socket, 1 is one accept per poll.
+  /// Must be called before @func start.
+  void setAcceptBatch(int batch) { acceptor_->setAcceptBatch(batch); }
+
+  /// accept counters summed over all acceptors,
+  /// may be called from any thread once started
+  Acceptor::Stats acceptStats() const;
+
+  /// See TcpConnection::setRttSampleInterval(), for every connection.
+  /// Must be called before @func start
+  void setRttSampleInterval(double seconds) {
+    assert(seconds >= 0);
+    rttSampleInterval_ = seconds;
+  }
+
+  /// Collects TcpConnection::stats() of live connections, e.g. sort by
+  /// outputQueuedMicroSeconds to find peers which don't keep up.
+  ///
+  /// Walks connections in the loop which owns them, only copying
+  /// counters, so IO loops are not held up. cb runs in that loop, or in
+  /// the last IO loop to finish in kReusePortPerLoop mode.
+  /// Thread safe.
+  void collectStats(StatsCallback cb);
+
  private:
   /// Not thread safe, but in loop
   void newConnection(int sockfd, const InetAddress& peerAddr);
+  /// kReusePortPerLoop, in ioLoop
+  void newConnectionInLoop(EventLoop* ioLoop, int sockfd,
+                           const InetAddress& peerAddr);
+  TcpConnectionPtr createConnection(EventLoop* ioLoop, int sockfd,
+                                    const InetAddress& peerAddr);
   /// Thread safe.
   void removeConnection(const TcpConnectionPtr& conn);
   /// Not thread safe, but in loop
   void removeConnectionInLoop(const TcpConnectionPtr& conn);
+  /// in loop thread, created on first connection of ioLoop
+  std::shared_ptr<IdleReaper> idleReaperOf(EventLoop* ioLoop);
 
   using ConnectionMap = std::map<std::string, TcpConnectionPtr>;
+
+  /// acceptor and connections of one IO loop in kReusePortPerLoop mode,
+  /// only touched in that loop.
+  struct LoopAcceptor {
+    std::unique_ptr<Acceptor> acceptor;
+    ConnectionMap connections;
+  };
+  /// in ioLoop, stops accepting and destroys its connections
+  void stopLoopAcceptorInLoop(LoopAcceptor* loopAcceptor,
+                              CountDownLatch* latch);
+  /// snapshot being collected from IO loops in kReusePortPerLoop
+  struct StatsCollector;
+  static void addStats(const ConnectionMap& connections,
+                       StatsSnapshot* snapshot);
+  void collectStatsInLoop(StatsCallback cb);
+  void collectLoopStatsInLoop(LoopAcceptor* loopAcceptor,
+                              const std::shared_ptr<StatsCollector>& collector);
+
   EventLoop* loop_;  // the acceptor loop
+  const InetAddress listenAddr_;
+  const Option option_;
   const std::string ipPort_;
   const std::string name_;
   std::unique_ptr<Acceptor> acceptor_;
@@ -99,8 +201,16 @@ class TcpServer : noncopyable {
   WriteCompleteCallback writeCompleteCallback_;
   ThreadInitCallback threadInitCallback_;
   std::atomic_flag started_;
-  int nextConnId_;  // always in loop thread, so no need to be atomic
+  std::atomic<int> nextConnId_;  // IO loops accept concurrently in kReusePortPerLoop
   ConnectionMap connections_;
+  int idleSeconds_;
+  bool edgeTriggered_;
+  int socketBusyPollMicroSeconds_;
+  double rttSampleInterval_;
+  /// in kReusePortPerLoop, both are built in start() before listening
+  /// and read only afterwards, so IO loops can look up without locking.
+  std::map<EventLoop*, std::shared_ptr<IdleReaper>> idleReapers_;
+  std::map<EventLoop*, std::unique_ptr<LoopAcceptor>> loopAcceptors_;
 };
 
 }  // namespace net
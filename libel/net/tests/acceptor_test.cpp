@@ -0,0 +1,59 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/tcp_server.h"
+#include "libel/net/tests/test_util.h"
+
+#include <cassert>
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const uint16_t kPort = 20624;
+const int kConnections = 64;
+
+/// connects a burst before the loop runs, so they wait in the backlog
+Acceptor::Stats acceptBurst(int batch) {
+  EventLoop loop;
+  InetAddress listenAddr(kPort, true);
+  TcpServer server(&loop, listenAddr, "AcceptorTest");
+  server.setAcceptBatch(batch);
+  server.start();
+
+  std::vector<int> fds;
+  for (int i = 0; i < kConnections; ++i) {
+    fds.push_back(connectTo(listenAddr));
+  }
+  loop.runAfter(0.2, [&loop] { loop.quit(); });
+  loop.loop();
+  for (int fd : fds) {
+    ::close(fd);
+  }
+  return server.acceptStats();
+}
+
+int main() {
+  Acceptor::Stats batched = acceptBurst(16);
+  printf("batch 16: accepted %ld wakeups %ld\n", batched.accepted,
+         batched.wakeups);
+  assert(batched.accepted == kConnections);
+  assert(batched.wakeups < batched.accepted);
+  assert(batched.wakeups >= kConnections / 16);
+  assert(batched.emfile == 0);
+
+  Acceptor::Stats single = acceptBurst(1);
+  printf("batch 1: accepted %ld wakeups %ld\n", single.accepted,
+         single.wakeups);
+  assert(single.accepted == kConnections);
+  assert(single.wakeups == single.accepted);
+  (void)batched;
+  (void)single;
+  printf("acceptor_test passed\n");
+  return 0;
+}
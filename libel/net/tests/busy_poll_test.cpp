@@ -0,0 +1,77 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Thread.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/socket.h"
+#include "libel/net/sockets_ops.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+
+using namespace Libel;
+using namespace Libel::net;
+
+std::atomic<int> g_pings(0);
+
+void ping() { ++g_pings; }
+
+/// pings the loop every millisecond, goes quiet, then quits it
+void producer(void* arg) {
+  EventLoop* loop = static_cast<EventLoop*>(arg);
+  for (int i = 0; i < 200; ++i) {
+    loop->queueInLoop(ping);
+    ::usleep(1000);
+  }
+  ::usleep(200 * 1000);
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+EventLoop::BusyPollStats run(int spinMicroSeconds) {
+  g_pings = 0;
+  EventLoop loop;
+  loop.setBusyPoll(spinMicroSeconds);
+  assert(loop.busyPoll() == spinMicroSeconds);
+  Thread thread(producer, &loop, "producer");
+  thread.start();
+  loop.loop();
+  thread.join();
+  assert(g_pings == 200);
+  EventLoop::BusyPollStats stats = loop.busyPollStats();
+  printf("spin %d us: spinPolls %ld, spinHits %ld, blockingWaits %ld\n",
+         spinMicroSeconds, stats.spinPolls, stats.spinHits,
+         stats.blockingWaits);
+  return stats;
+}
+
+int main() {
+  EventLoop::BusyPollStats off = run(0);
+  assert(off.spinPolls == 0);
+  assert(off.spinHits == 0);
+  assert(off.blockingWaits > 0);
+
+  /// pings come faster than the spin runs out, most are caught spinning
+  EventLoop::BusyPollStats on = run(20 * 1000);
+  assert(on.spinPolls > on.spinHits);
+  assert(on.spinHits >= 100);
+  /// falls back to blocking when quiet
+  assert(on.blockingWaits > 0);
+  assert(on.blockingWaits < off.blockingWaits);
+  (void)off;
+  (void)on;
+
+  Socket socket(sockets::createNonBlockingSocketOrDie(AF_INET));
+  if (socket.setBusyPoll(50)) {
+    int value = 0;
+    socklen_t len = static_cast<socklen_t>(sizeof value);
+    ::getsockopt(socket.fd(), SOL_SOCKET, SO_BUSY_POLL, &value, &len);
+    assert(value == 50);
+  } else {
+    printf("SO_BUSY_POLL not permitted, skipped\n");
+  }
+  printf("busy_poll_test passed\n");
+}
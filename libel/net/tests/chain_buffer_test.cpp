@@ -0,0 +1,192 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/chain_buffer.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+void testAppendRetrieve() {
+  ChainBuffer buffer;
+  assert(buffer.readableBytes() == 0);
+  assert(buffer.numSlabs() == 0);
+  assert(buffer.peek() == nullptr);
+
+  const std::string str(200, 'x');
+  buffer.append(str);
+  assert(buffer.readableBytes() == str.size());
+  assert(buffer.numSlabs() == 1);
+  assert(buffer.contiguousBytes() == str.size());
+
+  const std::string str2 = buffer.retrieveAsString(50);
+  assert(str2 == str.substr(0, 50));
+  assert(buffer.readableBytes() == 150);
+
+  std::string str3 = buffer.retrieveAllAsString();
+  assert(str3 == std::string(150, 'x'));
+  assert(buffer.readableBytes() == 0);
+  assert(buffer.numSlabs() == 0);
+}
+
+void testAppendAcrossSlabs() {
+  ChainBuffer buffer;
+  std::string big;
+  for (size_t i = 0; i < 3 * ChainBuffer::kSlabSize; ++i) {
+    big.push_back(static_cast<char>('a' + i % 26));
+  }
+  buffer.append(big);
+  assert(buffer.readableBytes() == big.size());
+  assert(buffer.numSlabs() == 4);
+  assert(buffer.contiguousBytes() ==
+         ChainBuffer::kSlabSize - ChainBuffer::kCheapPrepend);
+  const char* first = buffer.peek();
+
+  /// appending never moves existing bytes
+  buffer.append(big);
+  assert(buffer.peek() == first);
+  (void)first;
+  assert(buffer.readableBytes() == 2 * big.size());
+
+  buffer.retrieve(ChainBuffer::kSlabSize);
+  assert(buffer.numSlabs() == 6);
+  assert(buffer.retrieveAsString(big.size() - ChainBuffer::kSlabSize) ==
+         big.substr(ChainBuffer::kSlabSize));
+  assert(buffer.toString() == big);
+}
+
+void testPrepend() {
+  ChainBuffer buffer;
+  buffer.append(std::string(200, 'x'));
+  int32_t x = 0;
+  buffer.prepend(&x, sizeof(x));
+  assert(buffer.readableBytes() == 204);
+  assert(buffer.numSlabs() == 1);
+
+  /// no room in head slab, a new slab is linked before it
+  buffer.prependInt64(-1);
+  assert(buffer.readableBytes() == 212);
+  assert(buffer.numSlabs() == 2);
+  assert(buffer.readInt64() == -1);
+  assert(buffer.readInt32() == 0);
+  assert(buffer.retrieveAllAsString() == std::string(200, 'x'));
+
+  ChainBuffer empty;
+  std::string large(ChainBuffer::kSlabSize + 10, 'p');
+  empty.prepend(large.data(), large.size());
+  empty.append("tail");
+  assert(empty.toString() == large + "tail");
+}
+
+void testReadInt() {
+  ChainBuffer buffer;
+  buffer.append("HTTP");
+  assert(buffer.peekInt8() == 'H');
+  int top16 = buffer.peekInt16();
+  assert(top16 == 'H' * 256 + 'T');
+  assert(buffer.peekInt32() == top16 * 65536 + 'T' * 256 + 'P');
+  (void)top16;
+  buffer.retrieveAll();
+
+  /// an int32 lying across two slabs
+  buffer.append(std::string(ChainBuffer::kSlabSize - ChainBuffer::kCheapPrepend - 2, 'z'));
+  buffer.appendInt32(-3);
+  assert(buffer.numSlabs() == 2);
+  buffer.retrieve(ChainBuffer::kSlabSize - ChainBuffer::kCheapPrepend - 2);
+  assert(buffer.contiguousBytes() == 2);
+  assert(buffer.peekInt32() == -3);
+  assert(buffer.readInt32() == -3);
+  assert(buffer.readableBytes() == 0);
+}
+
+void testPullup() {
+  ChainBuffer buffer;
+  std::string data(ChainBuffer::kSlabSize, 'q');
+  data += "0123456789";
+  buffer.append(data);
+  buffer.retrieve(ChainBuffer::kSlabSize - 100);
+  assert(buffer.contiguousBytes() == 100 - ChainBuffer::kCheapPrepend);
+  const char* p = buffer.pullup(105);
+  assert(std::string(p, 105) == data.substr(ChainBuffer::kSlabSize - 100, 105));
+  (void)p;
+  assert(buffer.contiguousBytes() >= 105);
+  assert(buffer.toString() == data.substr(ChainBuffer::kSlabSize - 100));
+}
+
+void testMove() {
+  ChainBuffer buffer;
+  buffer.append("libel", 5);
+  const void* inner = buffer.peek();
+  ChainBuffer other(std::move(buffer));
+  assert(other.peek() == inner);
+  (void)inner;
+  assert(buffer.readableBytes() == 0);
+}
+
+void testReadWriteFd() {
+  int fds[2];
+  int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  assert(ret == 0);
+  (void)ret;
+  int sndbuf = 1024 * 1024;
+  ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+  ChainBuffer output;
+  std::string payload;
+  for (size_t i = 0; i < 2 * ChainBuffer::kSlabSize + 123; ++i) {
+    payload.push_back(static_cast<char>(i % 251));
+  }
+  output.append(payload);
+  struct iovec vec[8];
+  assert(output.peekIovec(vec, 8) == 3);
+  (void)vec;
+
+  int savedErrno = 0;
+  ssize_t n = output.writeFd(fds[0], &savedErrno);
+  assert(n == static_cast<ssize_t>(payload.size()));
+  assert(output.readableBytes() == 0);
+
+  ChainBuffer input;
+  size_t total = 0;
+  while (total < payload.size()) {
+    n = input.readFd(fds[1], &savedErrno);
+    assert(n > 0);
+    total += static_cast<size_t>(n);
+  }
+  assert(input.toString() == payload);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+void testSlabPool() {
+  detail::SlabPool& pool = detail::SlabPool::instance();
+  {
+    ChainBuffer buffer;
+    buffer.append(std::string(4 * ChainBuffer::kSlabSize, 'x'));
+  }
+  size_t cached = pool.cachedSlabs();
+  assert(cached >= 5);
+  {
+    ChainBuffer buffer;
+    buffer.append(std::string(4 * ChainBuffer::kSlabSize, 'x'));
+    assert(pool.cachedSlabs() == cached - 5);
+  }
+  assert(pool.cachedSlabs() == cached);
+  (void)cached;
+}
+
+int main() {
+  testAppendRetrieve();
+  testAppendAcrossSlabs();
+  testPrepend();
+  testReadInt();
+  testPullup();
+  testMove();
+  testReadWriteFd();
+  testSlabPool();
+  return 0;
+}
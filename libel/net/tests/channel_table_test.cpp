@@ -0,0 +1,108 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/channel.h"
+#include "libel/net/channel_table.h"
+#include "libel/net/eventloop.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+void testTable() {
+  ChannelTable table;
+  Channel* a = reinterpret_cast<Channel*>(0x10);
+  Channel* b = reinterpret_cast<Channel*>(0x20);
+  assert(table.find(3) == nullptr);
+  table.add(3, a);
+  assert(table.find(3) == a);
+  assert(table.contains(3, a));
+  assert(!table.contains(3, b));
+  assert(table.find(1000) == nullptr);
+  const uint32_t generation = table.generation(3);
+  assert(table.find(3, generation) == a);
+  table.remove(3, a);
+  assert(table.find(3) == nullptr);
+  /// fd 3 reused, events tagged for a are stale
+  table.add(3, b);
+  assert(table.find(3, generation) == nullptr);
+  (void)generation;
+  assert(table.find(3, table.generation(3)) == b);
+  table.add(100, a);
+  assert(table.size() == 2);
+}
+
+struct Pipe {
+  int fds[2];
+  std::unique_ptr<Channel> channel;
+  int reads;
+};
+
+/// registers many pipes, removes every other one out of order, then
+/// checks that events still reach the right channels.
+void testLoop() {
+  EventLoop loop;
+  const int kPipes = 200;
+  std::vector<std::unique_ptr<Pipe>> pipes;
+  for (int i = 0; i < kPipes; ++i) {
+    std::unique_ptr<Pipe> p(new Pipe);
+    int ret = ::pipe2(p->fds, O_NONBLOCK | O_CLOEXEC);
+    assert(ret == 0);
+    (void)ret;
+    p->reads = 0;
+    p->channel.reset(new Channel(&loop, p->fds[0]));
+    Pipe* raw = p.get();
+    p->channel->setReadCallback([raw](TimeStamp) {
+      char buf[16];
+      while (::read(raw->fds[0], buf, sizeof buf) > 0) {
+      }
+      ++raw->reads;
+    });
+    p->channel->enableReading();
+    pipes.push_back(std::move(p));
+  }
+  for (int i = kPipes - 1; i >= 0; i -= 2) {
+    Pipe* p = pipes[static_cast<size_t>(i)].get();
+    p->channel->disableAll();
+    p->channel->removeSelfFromLoop();
+    assert(!loop.hasChannel(get_pointer(p->channel)));
+  }
+  for (auto& p : pipes) {
+    ssize_t n = ::write(p->fds[1], "x", 1);
+    assert(n == 1);
+    (void)n;
+  }
+  loop.runAfter(0.1, std::bind(&EventLoop::quit, &loop));
+  loop.loop();
+  for (int i = 0; i < kPipes; ++i) {
+    Pipe* p = pipes[static_cast<size_t>(i)].get();
+    assert(p->reads == (i % 2 == 0 ? 1 : 0));
+    if (i % 2 == 0) {
+      assert(loop.hasChannel(get_pointer(p->channel)));
+      p->channel->disableAll();
+      p->channel->removeSelfFromLoop();
+    }
+    ::close(p->fds[0]);
+    ::close(p->fds[1]);
+  }
+}
+
+int main() {
+  testTable();
+  testLoop();
+  ::setenv("LIBEL_USE_POLL", "1", 1);
+  testLoop();
+  ::unsetenv("LIBEL_USE_POLL");
+  ::setenv("LIBEL_USE_IO_URING", "1", 1);
+  testLoop();
+  printf("channel_table_test passed\n");
+  return 0;
+}
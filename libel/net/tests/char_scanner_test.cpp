@@ -0,0 +1,147 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/timestamp.h"
+#include "libel/net/buffer.h"
+#include "libel/net/char_scanner.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const char* naiveFindCRLF(const char* begin, const char* end) {
+  const char kCRLF[] = "\r\n";
+  const char* crlf = std::search(begin, end, kCRLF, kCRLF + 2);
+  return crlf == end ? nullptr : crlf;
+}
+
+const char* naiveFindFirstOf(const char* begin, const char* end) {
+  for (const char* p = begin; p != end; ++p) {
+    /// the ranges tested below
+    if (*p == ' ' || *p == '?' || (*p >= '0' && *p <= '9')) return p;
+  }
+  return nullptr;
+}
+
+/// mostly letters, some bytes of interest, high bytes too
+std::string randomBytes(size_t len, int sparsity) {
+  static const char kSpecial[] = "\r\n ?5\x80\xff";
+  std::string bytes;
+  for (size_t i = 0; i < len; ++i) {
+    if (rand() % sparsity == 0) {
+      bytes.push_back(kSpecial[rand() % (sizeof kSpecial - 1)]);
+    } else {
+      bytes.push_back(static_cast<char>('a' + rand() % 26));
+    }
+  }
+  return bytes;
+}
+
+void testAgainstNaive() {
+  for (int round = 0; round < 20000; ++round) {
+    const int sparsity = 1 + rand() % 100;
+    std::string bytes = randomBytes(static_cast<size_t>(rand() % 200), sparsity);
+    const size_t offset = bytes.empty() ? 0 : rand() % (bytes.size() + 1);
+    const char* begin = bytes.data() + offset;
+    const char* end = bytes.data() + bytes.size();
+    assert(CharScanner::findCRLF(begin, end) == naiveFindCRLF(begin, end));
+    assert(CharScanner::findFirstOf(begin, end, "  ??09", 3) ==
+           naiveFindFirstOf(begin, end));
+    (void)begin;
+    (void)end;
+  }
+  /// CRLF across the boundary of every vector
+  for (size_t pos = 0; pos < 100; ++pos) {
+    std::string bytes(100, 'x');
+    bytes[pos] = '\r';
+    const char* begin = bytes.data();
+    const char* end = begin + bytes.size();
+    assert(CharScanner::findCRLF(begin, end) == nullptr);
+    if (pos + 1 < bytes.size()) {
+      bytes[pos + 1] = '\n';
+      assert(CharScanner::findCRLF(begin, end) == begin + pos);
+    }
+    (void)begin;
+    (void)end;
+  }
+}
+
+void testBuffer() {
+  Buffer buffer;
+  buffer.append(std::string(100, 'x'));
+  buffer.append("\r\n");
+  buffer.append(std::string(100, 'y'));
+  buffer.append("\n");
+  assert(buffer.findCRLF() == buffer.peek() + 100);
+  assert(buffer.findCRLF(buffer.peek() + 101) == nullptr);
+  assert(buffer.findEOL() == buffer.peek() + 101);
+  assert(buffer.findEOL(buffer.peek() + 102) == buffer.peek() + 202);
+}
+
+using FindCRLF = const char* (*)(const char*, const char*);
+
+/// keeps the optimizer from dropping the scans
+volatile int g_lines = 0;
+
+double gbPerSecond(FindCRLF find, const std::string& bytes, int rounds,
+                   int expected) {
+  const char* begin = bytes.data();
+  const char* end = begin + bytes.size();
+  TimeStamp start(TimeStamp::now());
+  for (int i = 0; i < rounds; ++i) {
+    int lines = 0;
+    for (const char* p = begin; (p = find(p, end)) != nullptr; p += 2) {
+      ++lines;
+    }
+    assert(lines == expected);
+    (void)expected;
+    g_lines = lines;
+  }
+  double seconds = timeDiffInSeconds(TimeStamp::now(), start);
+  return static_cast<double>(bytes.size()) * rounds / seconds / 1e9;
+}
+
+void benchmark(bool baseline) {
+  /// header lines of typical length
+  std::string headers;
+  int numLines = 0;
+  while (headers.size() < 64 * 1024) {
+    headers.append("X-Header-").append(std::to_string(numLines));
+    headers.append(": ").append(static_cast<size_t>(10 + rand() % 60), 'v');
+    headers.append("\r\n");
+    ++numLines;
+  }
+  /// one long line, lone CRs on the way
+  std::string body(64 * 1024, 'x');
+  for (size_t i = 100; i < body.size(); i += 1000) body[i] = '\r';
+  body.append("\r\n");
+  if (baseline) {
+    printf("%-7s findCRLF headers %.2f GB/s, long line %.2f GB/s\n",
+           "search", gbPerSecond(naiveFindCRLF, headers, 200, numLines),
+           gbPerSecond(naiveFindCRLF, body, 200, 1));
+  }
+  printf("%-7s findCRLF headers %.2f GB/s, long line %.2f GB/s\n",
+         CharScanner::isaName(CharScanner::isa()),
+         gbPerSecond(CharScanner::findCRLF, headers, 2000, numLines),
+         gbPerSecond(CharScanner::findCRLF, body, 2000, 1));
+}
+
+int main() {
+  const CharScanner::Isa supported = CharScanner::supportedIsa();
+  printf("supported: %s\n", CharScanner::isaName(supported));
+  /// the default is the widest
+  assert(CharScanner::isa() == supported);
+  for (int isa = CharScanner::kScalar; isa <= supported; ++isa) {
+    CharScanner::setIsa(static_cast<CharScanner::Isa>(isa));
+    testAgainstNaive();
+    testBuffer();
+    benchmark(isa == CharScanner::kScalar);
+  }
+  printf("char_scanner_test passed\n");
+}
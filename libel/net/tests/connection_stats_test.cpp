@@ -0,0 +1,148 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Thread.h"
+#include "libel/base/countdown_latch.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/tcp_server.h"
+#include "libel/net/tests/test_util.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const size_t kHighWaterMark = 1024 * 1024;
+const size_t kFloodBytes = 8 * 1024 * 1024;
+
+std::atomic<int> g_highWaterMarks(0);
+
+void onConnection(const TcpConnectionPtr& conn) {
+  if (conn->connected()) {
+    conn->setHighWaterMarkCallback(
+        [](const TcpConnectionPtr&, uint32_t) { ++g_highWaterMarks; },
+        kHighWaterMark);
+  }
+}
+
+void onMessage(const TcpConnectionPtr& conn, Buffer* buffer, TimeStamp) {
+  if (buffer->readableBytes() >= 5 &&
+      ::memcmp(buffer->peek(), "flood", 5) == 0) {
+    buffer->retrieveAll();
+    conn->send(std::string(kFloodBytes, 'x'));
+  } else {
+    conn->send(buffer);
+  }
+}
+
+TcpServer::StatsSnapshot collect(TcpServer* server) {
+  TcpServer::StatsSnapshot result;
+  CountDownLatch latch(1);
+  server->collectStats([&](const TcpServer::StatsSnapshot& snapshot) {
+    result = snapshot;
+    latch.countDown();
+  });
+  latch.wait();
+  return result;
+}
+
+void drive(EventLoop* loop, TcpServer* server, const InetAddress& addr) {
+  int echoFd = connectTo(addr);
+  char buf[64 * 1024];
+  for (int i = 0; i < 10; ++i) {
+    ssize_t n = ::write(echoFd, "hello", 5);
+    assert(n == 5);
+    n = ::read(echoFd, buf, 5);
+    assert(n == 5);
+    (void)n;
+  }
+  /// doesn't read for a while, the server has to queue the flood
+  int floodFd = connectTo(addr);
+  ssize_t n = ::write(floodFd, "flood", 5);
+  assert(n == 5);
+  (void)n;
+  ::usleep(300 * 1000);
+
+  TcpServer::StatsSnapshot snapshot = collect(server);
+  assert(snapshot.connections.size() == 2);
+  const TcpConnection::Stats* echo = nullptr;
+  const TcpConnection::Stats* flood = nullptr;
+  for (const auto& entry : snapshot.connections) {
+    const TcpConnection::Stats& stats = entry.stats;
+    printf("%s: read %ld bytes in %ld messages, wrote %ld bytes of %ld "
+           "messages, queued %ld us, high water %ld, rtt %ld us\n",
+           entry.name.c_str(), stats.bytesRead, stats.messagesRead,
+           stats.bytesWritten, stats.messagesSent,
+           stats.outputQueuedMicroSeconds, stats.highWaterMarks,
+           stats.rttMicroSeconds);
+    (stats.bytesRead == 5 ? flood : echo) = &stats;
+  }
+  assert(echo && flood);
+  assert(echo->bytesRead == 50 && echo->bytesWritten == 50);
+  assert(echo->messagesRead == 10 && echo->messagesSent == 10);
+  assert(echo->reads == 10);
+  assert(echo->outputQueuedMicroSeconds == 0);
+  assert(echo->highWaterMarks == 0);
+  assert(echo->rttSampleTime > 0 && echo->rttMicroSeconds > 0);
+  assert(flood->messagesSent == 1);
+  assert(flood->bytesWritten < static_cast<int64_t>(kFloodBytes));
+  assert(flood->outputQueuedMicroSeconds >= 200 * 1000);
+  assert(flood->highWaterMarks == 1);
+  assert(snapshot.total.bytesRead == 55);
+  assert(snapshot.total.highWaterMarks == 1);
+
+  size_t received = 0;
+  while (received < kFloodBytes) {
+    n = ::read(floodFd, buf, sizeof buf);
+    assert(n > 0);
+    received += static_cast<size_t>(n);
+  }
+  ::usleep(100 * 1000);
+  snapshot = collect(server);
+  assert(snapshot.connections.size() == 2);
+  for (const auto& entry : snapshot.connections) {
+    if (entry.stats.bytesRead == 5) {
+      assert(entry.stats.bytesWritten == static_cast<int64_t>(kFloodBytes));
+      /// drained, no longer growing
+      int64_t queued = entry.stats.outputQueuedMicroSeconds;
+      assert(queued == collect(server).total.outputQueuedMicroSeconds);
+      (void)queued;
+    }
+  }
+  ::close(echoFd);
+  ::close(floodFd);
+  ::usleep(100 * 1000);
+  assert(collect(server).connections.empty());
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+void run(TcpServer::Option option, uint16_t port) {
+  g_highWaterMarks = 0;
+  EventLoop loop;
+  InetAddress listenAddr(port, true);
+  TcpServer server(&loop, listenAddr, "StatsServer", option);
+  server.setThreadNum(2);
+  server.setRttSampleInterval(0.001);
+  server.setConnectionCallback(onConnection);
+  server.setMessageCallback(onMessage);
+  server.start();
+  Thread driver(std::bind(drive, &loop, &server, listenAddr), nullptr);
+  driver.start();
+  loop.loop();
+  driver.join();
+  assert(g_highWaterMarks == 1);
+}
+
+int main() {
+  run(TcpServer::kNoReusePort, 20621);
+  run(TcpServer::kReusePortPerLoop, 20622);
+  printf("connection_stats_test passed\n");
+  return 0;
+}
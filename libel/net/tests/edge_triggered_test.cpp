@@ -0,0 +1,96 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Thread.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/tcp_server.h"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const uint16_t kPort = 20620;
+const int kClients = 4;
+/// well over TcpConnection::kEdgeTriggeredBudget, both ways
+const size_t kBytes = 8 * 1024 * 1024;
+
+std::atomic<int> g_finished(0);
+
+char patternAt(size_t index, int client) {
+  return static_cast<char>((index * 7 + static_cast<size_t>(client)) % 251);
+}
+
+void onMessage(const TcpConnectionPtr& conn, Buffer* buffer, TimeStamp) {
+  conn->send(buffer);
+}
+
+void writeAll(int fd, int client) {
+  std::string chunk;
+  size_t sent = 0;
+  while (sent < kBytes) {
+    chunk.clear();
+    for (size_t i = 0; i < 64 * 1024 && sent + i < kBytes; ++i) {
+      chunk.push_back(patternAt(sent + i, client));
+    }
+    ssize_t n = ::write(fd, chunk.data(), chunk.size());
+    assert(n == static_cast<ssize_t>(chunk.size()));
+    sent += chunk.size();
+    (void)n;
+  }
+}
+
+void runClient(EventLoop* loop, const InetAddress& addr, int client) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  assert(fd >= 0);
+  int ret = ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+  assert(ret == 0);
+  (void)ret;
+  /// writes from another thread, the echo would fill up both directions
+  Thread writer(std::bind(writeAll, fd, client), nullptr);
+  writer.start();
+  char buf[64 * 1024];
+  size_t received = 0;
+  while (received < kBytes) {
+    ssize_t n = ::read(fd, buf, sizeof buf);
+    assert(n > 0);
+    for (ssize_t i = 0; i < n; ++i) {
+      assert(buf[i] == patternAt(received + static_cast<size_t>(i), client));
+    }
+    received += static_cast<size_t>(n);
+  }
+  writer.join();
+  ::close(fd);
+  if (++g_finished == kClients) {
+    loop->runInLoop(std::bind(&EventLoop::quit, loop));
+  }
+}
+
+int main() {
+  EventLoop loop;
+  assert(loop.supportsEdgeTriggered());
+  InetAddress listenAddr(kPort, true);
+  TcpServer server(&loop, listenAddr, "EdgeTriggeredServer");
+  server.setEdgeTriggered(true);
+  server.setConnectionCallback([](const TcpConnectionPtr&) {});
+  server.setMessageCallback(onMessage);
+  server.start();
+  std::vector<std::unique_ptr<Thread>> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back(
+        new Thread(std::bind(runClient, &loop, listenAddr, i), nullptr));
+    clients.back()->start();
+  }
+  loop.loop();
+  for (auto& client : clients) {
+    client->join();
+  }
+  printf("echoed %zu bytes to each of %d clients\n", kBytes, kClients);
+  return 0;
+}
@@ -0,0 +1,91 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Thread.h"
+#include "libel/net/eventloop.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+
+using namespace Libel;
+using namespace Libel::net;
+
+std::atomic<int> g_functors(0);
+int g_timers = 0;
+
+void onFunctor() { ++g_functors; }
+
+void slowFunctor() {
+  ::usleep(30 * 1000);
+  ++g_functors;
+}
+
+void onTimer() {
+  ++g_timers;
+  /// slow channel handler, the timerfd
+  ::usleep(30 * 1000);
+}
+
+void print(const EventLoop::Metrics& m) {
+  printf("iterations %ld, pollWait %ld us, activeChannels %ld (max %ld)\n",
+         m.iterations, m.pollWaitMicroSeconds, m.activeChannels,
+         m.maxActiveChannels);
+  printf("handlers %ld us (max %ld), functors %ld in %ld us, "
+         "delay %ld us (max %ld), maxQueueSize %ld, slow %ld, "
+         "poller syscalls %ld\n",
+         m.handlerMicroSeconds, m.maxHandlerMicroSeconds, m.functors,
+         m.functorMicroSeconds, m.functorDelayMicroSeconds,
+         m.maxFunctorDelayMicroSeconds, m.maxQueueSize, m.slowCallbacks,
+         m.pollerSyscalls);
+}
+
+void producer(void* arg) {
+  EventLoop* loop = static_cast<EventLoop*>(arg);
+  for (int i = 0; i < 100; ++i) {
+    loop->queueInLoop(onFunctor);
+  }
+  ::usleep(100 * 1000);
+  /// read without locking while the loop is running
+  EventLoop::Metrics m = loop->metrics();
+  assert(m.functors >= 100);
+  assert(m.iterations > 0);
+  (void)m;
+  loop->queueInLoop(slowFunctor);
+  ::usleep(100 * 1000);
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+int main() {
+  EventLoop loop;
+  loop.setSlowCallbackThreshold(0.01);
+  loop.runAfter(0.05, onTimer);
+  Thread thread(producer, &loop, "producer");
+  thread.start();
+  loop.loop();
+  thread.join();
+  assert(g_functors == 101);
+  assert(g_timers == 1);
+
+  EventLoop::Metrics m = loop.metrics();
+  print(m);
+  assert(m.iterations == loop.iteration());
+  assert(m.activeChannels >= m.iterations - 1);
+  assert(m.maxActiveChannels >= 1);
+  /// mostly sleeping in poll
+  assert(m.pollWaitMicroSeconds > 100 * 1000);
+  assert(m.maxHandlerMicroSeconds >= 30 * 1000);
+  assert(m.handlerMicroSeconds >= m.maxHandlerMicroSeconds);
+  /// the quit functor too
+  assert(m.functors == 102);
+  assert(m.functorMicroSeconds >= 30 * 1000);
+  assert(m.maxFunctorDelayMicroSeconds <= m.functorDelayMicroSeconds);
+  assert(m.maxQueueSize >= 1 && m.maxQueueSize <= 101);
+  /// the timer handler and the slow functor
+  assert(m.slowCallbacks == 2);
+  /// a wait per iteration, at least
+  assert(m.pollerSyscalls >= m.iterations);
+  printf("eventloop_metrics_test passed\n");
+}
@@ -0,0 +1,72 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/tcp_server.h"
+#include "libel/net/tests/test_util.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const uint16_t kPort = 20617;
+
+void keepAlive(int fd) {
+  ssize_t n = ::write(fd, "x", 1);
+  assert(n == 1);
+  (void)n;
+}
+
+void check(EventLoop* loop, int idleFd, int activeFd, const int* numClosed) {
+  char buf[16];
+  /// server closed the idle one
+  ssize_t n = ::recv(idleFd, buf, sizeof(buf), MSG_DONTWAIT);
+  printf("idle connection recv %zd\n", n);
+  assert(n == 0);
+  /// but not the active one
+  n = ::recv(activeFd, buf, sizeof(buf), MSG_DONTWAIT);
+  printf("active connection recv %zd\n", n);
+  assert(n < 0 && errno == EAGAIN);
+  /// the idle one and the one shut down but never closed by client
+  printf("server closed %d connections\n", *numClosed);
+  assert(*numClosed == 2);
+  loop->quit();
+}
+
+int main() {
+  EventLoop loop;
+  InetAddress listenAddr(kPort, true);
+  TcpServer server(&loop, listenAddr, "IdleReaperTest");
+  server.setIdleTimeout(1);
+  int numClosed = 0;
+  server.setConnectionCallback([&numClosed](const TcpConnectionPtr& conn) {
+    if (conn->disconnected()) ++numClosed;
+  });
+  server.setMessageCallback(
+      [](const TcpConnectionPtr& conn, Buffer* buffer, TimeStamp) {
+        /// "q" asks for shutdown, like Connection: close
+        if (buffer->retrieveAllAsString() == "q") conn->shutdown();
+      });
+  server.start();
+
+  int idleFd = connectTo(listenAddr);
+  int activeFd = connectTo(listenAddr);
+  int shutdownFd = connectTo(listenAddr);
+  ssize_t n = ::write(shutdownFd, "q", 1);
+  assert(n == 1);
+  (void)n;
+  loop.runEvery(0.3, std::bind(keepAlive, activeFd));
+  loop.runAfter(3.5, std::bind(check, &loop, idleFd, activeFd, &numClosed));
+  loop.loop();
+  ::close(idleFd);
+  ::close(activeFd);
+  ::close(shutdownFd);
+  return 0;
+}
@@ -0,0 +1,113 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/channel.h"
+#include "libel/net/eventloop.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+bool hasIoUringFd() {
+  DIR* dir = ::opendir("/proc/self/fd");
+  assert(dir);
+  bool found = false;
+  char path[512];
+  char target[64];
+  while (struct dirent* entry = ::readdir(dir)) {
+    snprintf(path, sizeof path, "/proc/self/fd/%s", entry->d_name);
+    ssize_t n = ::readlink(path, target, sizeof target - 1);
+    if (n > 0) {
+      target[n] = '\0';
+      found = found || strstr(target, "io_uring") != nullptr;
+    }
+  }
+  ::closedir(dir);
+  return found;
+}
+
+/// level triggered, fires while there is anything left to read
+void testLevelTriggered() {
+  EventLoop eventLoop;
+  EventLoop* loop = &eventLoop;
+  int fds[2];
+  int ret = ::pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+  assert(ret == 0);
+  (void)ret;
+  ssize_t n = ::write(fds[1], "0123456789", 10);
+  assert(n == 10);
+  (void)n;
+  int reads = 0;
+  Channel channel(loop, fds[0]);
+  channel.setReadCallback([&](TimeStamp) {
+    char c;
+    if (::read(fds[0], &c, 1) == 1) ++reads;
+  });
+  channel.enableReading();
+  loop->runAfter(0.2, std::bind(&EventLoop::quit, loop));
+  loop->loop();
+  assert(reads == 10);
+  channel.disableAll();
+  channel.removeSelfFromLoop();
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+/// edge triggered, fires once per change, write interest costs nothing
+void testEdgeTriggered() {
+  EventLoop eventLoop;
+  EventLoop* loop = &eventLoop;
+  assert(loop->supportsEdgeTriggered());
+  int fds[2];
+  int ret = ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds);
+  assert(ret == 0);
+  (void)ret;
+  int reads = 0;
+  int writes = 0;
+  Channel channel(loop, fds[0]);
+  channel.setEdgeTriggered(true);
+  channel.setReadCallback([&](TimeStamp) { ++reads; });
+  channel.setWriteCallback([&]() { ++writes; });
+  channel.enableReading();
+  channel.enableWriting();
+  channel.disableWriting();
+  ssize_t n = ::write(fds[1], "x", 1);
+  assert(n == 1);
+  (void)n;
+  loop->runAfter(0.1, [&]() {
+    /// not read, no new edge, no more events
+    assert(reads == 1);
+    n = ::write(fds[1], "y", 1);
+  });
+  loop->runAfter(0.2, std::bind(&EventLoop::quit, loop));
+  loop->loop();
+  assert(reads == 2);
+  assert(writes >= 1);
+  channel.disableAll();
+  channel.removeSelfFromLoop();
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+int main() {
+  ::setenv("LIBEL_USE_IO_URING", "1", 1);
+  {
+    EventLoop loop;
+    if (!hasIoUringFd()) {
+      printf("io_uring is not supported, fell back to epoll\n");
+      return 0;
+    }
+  }
+  testLevelTriggered();
+  testEdgeTriggered();
+  printf("io_uring_poller_test passed\n");
+  return 0;
+}
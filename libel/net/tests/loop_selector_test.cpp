@@ -0,0 +1,194 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Mutex.h"
+#include "libel/base/Thread.h"
+#include "libel/base/countdown_latch.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/eventloop_threadpool.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/loop_selector.h"
+#include "libel/net/tcp_server.h"
+#include "libel/net/tests/test_util.h"
+
+#include <cassert>
+#include <cstdio>
+#include <set>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const uint16_t kPort = 20619;
+const int kThreads = 3;
+
+void testJumpConsistentHash() {
+  for (uint64_t key = 0; key < 10000; ++key) {
+    int32_t last = LoopSelector::jumpConsistentHash(key, 1);
+    assert(last == 0);
+    for (int32_t n = 2; n <= 16; ++n) {
+      int32_t bucket = LoopSelector::jumpConsistentHash(key, n);
+      assert(0 <= bucket && bucket < n);
+      /// a key either stays or moves to the new bucket
+      assert(bucket == last || bucket == n - 1);
+      last = bucket;
+    }
+    (void)last;
+  }
+}
+
+void testConsistentHash(const std::vector<EventLoop*>& loops) {
+  std::unique_ptr<LoopSelector> selector(LoopSelector::newConsistentHash());
+  selector->setLoops(loops);
+  std::set<EventLoop*> used;
+  char ip[32];
+  for (int i = 0; i < 256; ++i) {
+    snprintf(ip, sizeof ip, "10.0.%d.%d", i / 16, i % 16);
+    EventLoop* loop = selector->select(InetAddress(ip, 1000));
+    /// port doesn't matter
+    assert(selector->select(InetAddress(ip, 2000)) == loop);
+    used.insert(loop);
+  }
+  assert(used.size() == loops.size());
+}
+
+void testLeastConnections(const std::vector<EventLoop*>& loops) {
+  LeastConnectionsSelector selector;
+  selector.setLoops(loops);
+  InetAddress peer;
+  selector.connectionAdded(loops[0]);
+  selector.connectionAdded(loops[0]);
+  selector.connectionAdded(loops[1]);
+  assert(selector.select(peer) == loops[2]);
+  selector.connectionAdded(loops[2]);
+  /// loops[1] and loops[2] both have one
+  EventLoop* loop = selector.select(peer);
+  assert(loop == loops[1] || loop == loops[2]);
+  (void)loop;
+  selector.connectionRemoved(loops[0]);
+  selector.connectionRemoved(loops[0]);
+  assert(selector.numConnections(loops[0]) == 0);
+  assert(selector.select(peer) == loops[0]);
+}
+
+void testLeastPendingFunctors(const std::vector<EventLoop*>& loops) {
+  std::unique_ptr<LoopSelector> selector(
+      LoopSelector::newLeastPendingFunctors());
+  selector->setLoops(loops);
+  CountDownLatch blocked(1);
+  CountDownLatch release(1);
+  loops[0]->runInLoop([&]() {
+    blocked.countDown();
+    release.wait();
+  });
+  blocked.wait();
+  for (int i = 0; i < 10; ++i) {
+    loops[0]->queueInLoop([]() {});
+  }
+  InetAddress peer;
+  for (int i = 0; i < 10; ++i) {
+    assert(selector->select(peer) != loops[0]);
+  }
+  release.countDown();
+}
+
+MutexLock g_mutex;
+std::vector<EventLoop*> g_connectedLoops;
+LeastConnectionsSelector* g_selector = nullptr;
+
+void onConnection(const TcpConnectionPtr& conn) {
+  if (conn->connected()) {
+    MutexLockGuard lock(g_mutex);
+    g_connectedLoops.push_back(conn->getLoop());
+  }
+}
+
+size_t numConnected() {
+  MutexLockGuard lock(g_mutex);
+  return g_connectedLoops.size();
+}
+
+int64_t numConnections(const std::vector<EventLoop*>& loops) {
+  int64_t total = 0;
+  for (EventLoop* loop : loops) {
+    total += g_selector->numConnections(loop);
+  }
+  return total;
+}
+
+int connectOneByOne(const InetAddress& addr) {
+  int fd = connectTo(addr);
+  /// one at a time, so that the order of g_connectedLoops is known
+  size_t expected = numConnected() + 1;
+  while (numConnected() < expected) {
+    ::usleep(1000);
+  }
+  return fd;
+}
+
+void runClients(EventLoop* loop, TcpServer* server, const InetAddress& addr) {
+  std::vector<EventLoop*> loops;
+  {
+    CountDownLatch latch(1);
+    loop->runInLoop([&]() {
+      loops = server->threadPool()->getAllLoops();
+      latch.countDown();
+    });
+    latch.wait();
+  }
+  std::vector<int> fds;
+  for (int i = 0; i < kThreads; ++i) {
+    fds.push_back(connectOneByOne(addr));
+  }
+  /// one per loop
+  assert(std::set<EventLoop*>(g_connectedLoops.begin(), g_connectedLoops.end())
+             .size() == static_cast<size_t>(kThreads));
+  ::close(fds[1]);
+  while (numConnections(loops) != kThreads - 1) {
+    ::usleep(1000);
+  }
+  /// round robin would pick the first loop
+  fds[1] = connectOneByOne(addr);
+  assert(g_connectedLoops.back() == g_connectedLoops[1]);
+  for (int fd : fds) {
+    ::close(fd);
+  }
+  while (numConnections(loops) != 0) {
+    ::usleep(1000);
+  }
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+void testTcpServer() {
+  EventLoop loop;
+  InetAddress listenAddr(kPort, true);
+  TcpServer server(&loop, listenAddr, "LoopSelectorServer");
+  server.setThreadNum(kThreads);
+  g_selector = new LeastConnectionsSelector;
+  server.setLoopSelector(std::unique_ptr<LoopSelector>(g_selector));
+  server.setConnectionCallback(onConnection);
+  server.start();
+  Thread client(std::bind(runClients, &loop, &server, listenAddr), nullptr);
+  client.start();
+  loop.loop();
+  client.join();
+}
+
+int main() {
+  testJumpConsistentHash();
+  {
+    EventLoop loop;
+    EventLoopThreadPool pool(&loop, "LoopSelectorTest");
+    pool.setThreadNum(kThreads);
+    pool.start();
+    std::vector<EventLoop*> loops = pool.getAllLoops();
+    testConsistentHash(loops);
+    testLeastConnections(loops);
+    testLeastPendingFunctors(loops);
+  }
+  testTcpServer();
+  printf("loop_selector_test passed\n");
+  return 0;
+}
@@ -0,0 +1,87 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Mutex.h"
+#include "libel/base/Thread.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/tcp_server.h"
+#include "libel/net/tests/test_util.h"
+
+#include <cassert>
+#include <cstdio>
+#include <set>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const uint16_t kPort = 20618;
+const int kThreads = 4;
+const int kClients = 64;
+
+EventLoop* g_baseLoop = nullptr;
+MutexLock g_mutex;
+std::set<EventLoop*> g_loops;
+std::atomic<int> g_connected(0);
+
+void onConnection(const TcpConnectionPtr& conn) {
+  /// accepted and served by the IO loop itself
+  assert(conn->getLoop() != g_baseLoop);
+  assert(conn->getLoop()->isInLoopThread());
+  if (conn->connected()) {
+    ++g_connected;
+    MutexLockGuard lock(g_mutex);
+    g_loops.insert(conn->getLoop());
+  }
+}
+
+void onMessage(const TcpConnectionPtr& conn, Buffer* buffer, TimeStamp) {
+  conn->send(buffer);
+}
+
+void runClients(EventLoop* loop, const InetAddress& addr) {
+  std::vector<int> fds;
+  for (int i = 0; i < kClients; ++i) {
+    fds.push_back(connectTo(addr));
+  }
+  for (int fd : fds) {
+    char buf[8] = "libel";
+    ssize_t n = ::write(fd, buf, 5);
+    assert(n == 5);
+    n = ::read(fd, buf, sizeof(buf));
+    assert(n == 5);
+    (void)n;
+  }
+  /// half of them are still open when the server is destroyed
+  for (int i = 0; i < kClients / 2; ++i) {
+    ::close(fds[static_cast<size_t>(i)]);
+  }
+  printf("connected %d, served by %zu loops\n", g_connected.load(),
+         g_loops.size());
+  assert(g_connected == kClients);
+  assert(g_loops.size() > 1);
+  loop->runInLoop(std::bind(&EventLoop::quit, loop));
+}
+
+int main() {
+  EventLoop loop;
+  g_baseLoop = &loop;
+  InetAddress listenAddr(kPort, true);
+  {
+    TcpServer server(&loop, listenAddr, "ReusePortServer",
+                     TcpServer::kReusePortPerLoop);
+    server.setThreadNum(kThreads);
+    server.setConnectionCallback(onConnection);
+    server.setMessageCallback(onMessage);
+    server.start();
+    /// connects from another thread, the base loop must not be involved
+    Thread client(std::bind(runClients, &loop, listenAddr), nullptr);
+    client.start();
+    loop.loop();
+    client.join();
+  }
+  return 0;
+}
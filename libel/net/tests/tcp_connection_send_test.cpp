@@ -0,0 +1,344 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/base/Thread.h"
+#include "libel/net/buffer.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/inet_address.h"
+#include "libel/net/sockets_ops.h"
+#include "libel/net/tcp_connection.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const size_t kHighWaterMark = 64 * 1024;
+/// more than a socketpair takes in one write
+const size_t kLargeMessage = 4 * 1024 * 1024;
+
+/// reads until n bytes or EOF
+std::string readFully(int fd, size_t n) {
+  std::string data;
+  char buf[64 * 1024];
+  while (data.size() < n) {
+    ssize_t nr = ::read(fd, buf, std::min(sizeof buf, n - data.size()));
+    if (nr <= 0) break;
+    data.append(buf, static_cast<size_t>(nr));
+  }
+  return data;
+}
+
+/// Our end of a socketpair as a connected TcpConnection, peer is
+/// blocking. capacity, if given, is what one write to the empty socket
+/// takes, a write larger than it is partial.
+TcpConnectionPtr newConnection(EventLoop* loop, int* peer,
+                               size_t* capacity = nullptr) {
+  int fds[2];
+  int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  assert(ret == 0);
+  (void)ret;
+  sockets::setNonBlockingAndCloseOnExecOrDie(fds[0]);
+  *peer = fds[1];
+  if (capacity) {
+    const std::string probe(kLargeMessage, 'p');
+    ssize_t n = ::write(fds[0], probe.data(), probe.size());
+    assert(n > 0 && static_cast<size_t>(n) < probe.size());
+    *capacity = static_cast<size_t>(n);
+    std::string drained = readFully(fds[1], *capacity);
+    assert(drained == probe.substr(0, *capacity));
+    (void)drained;
+  }
+  TcpConnectionPtr conn = std::make_shared<TcpConnection>(
+      loop, "send_test", fds[0], InetAddress(), InetAddress());
+  conn->setConnectionCallback([](const TcpConnectionPtr&) {});
+  conn->setCloseCallback([](const TcpConnectionPtr& c) {
+    c->getLoop()->queueInLoop(std::bind(&TcpConnection::connectDestroyed, c));
+  });
+  conn->connectEstablished();
+  return conn;
+}
+
+/// runs loop until the peer has read n bytes or EOF, or until something
+/// else quits it if not quitLoop
+std::string receive(EventLoop* loop, int peer, size_t n,
+                    bool quitLoop = true) {
+  std::string data;
+  Thread reader(
+      [&](void*) {
+        data = readFully(peer, n);
+        if (quitLoop) loop->quit();
+      },
+      nullptr, "reader");
+  reader.start();
+  loop->loop();
+  reader.join();
+  return data;
+}
+
+void destroy(const TcpConnectionPtr& conn, int peer) {
+  if (!conn->disconnected()) conn->connectDestroyed();
+  ::close(peer);
+}
+
+/// an unlinked temporary file holding content
+int tempFile(const std::string& content) {
+  char name[] = "/tmp/send_testXXXXXX";
+  int fd = ::mkstemp(name);
+  assert(fd >= 0);
+  ::unlink(name);
+  ssize_t n = ::write(fd, content.data(), content.size());
+  assert(n == static_cast<ssize_t>(content.size()));
+  (void)n;
+  return fd;
+}
+
+/// segments of distinct bytes, and what they send
+struct Segments {
+  Segments(int count, size_t size) {
+    for (int i = 0; i < count; ++i) {
+      data.push_back(std::string(size, static_cast<char>('A' + i % 26)));
+      joined += data.back();
+    }
+    for (std::string& d : data) {
+      struct iovec vec;
+      vec.iov_base = &d[0];
+      vec.iov_len = d.size();
+      iov.push_back(vec);
+    }
+  }
+  int count() const { return static_cast<int>(iov.size()); }
+
+  std::vector<std::string> data;
+  std::vector<struct iovec> iov;
+  std::string joined;
+};
+
+/// Responses written the way HttpServer does, headers in place and a
+/// large body by send(iov) in between: one message and one high water
+/// mark crossing each.
+void testSendInBracket() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  int highWaterMarks = 0;
+  conn->setHighWaterMarkCallback(
+      [&highWaterMarks](const TcpConnectionPtr&, uint32_t) {
+        ++highWaterMarks;
+      },
+      kHighWaterMark);
+  const std::string body(kLargeMessage, 'b');
+  const std::string header = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                             std::to_string(body.size()) + "\r\n\r\n";
+  int responses = 0;
+  auto respond = [&] {
+    Buffer* output = conn->beginSend();
+    output->append(header);
+    struct iovec vec;
+    vec.iov_base = const_cast<char*>(body.data());
+    vec.iov_len = body.size();
+    conn->send(&vec, 1);
+    conn->endSend();
+    ++responses;
+  };
+  /// the next one after the previous drained, to cross the mark again
+  conn->setWriteCompleteCallback([&](const TcpConnectionPtr&) {
+    if (responses < 2) respond();
+  });
+  respond();
+  std::string received =
+      receive(&loop, peer, 2 * (header.size() + body.size()));
+  assert(received == header + body + header + body);
+  assert(highWaterMarks == 2);
+  TcpConnection::Stats stats = conn->stats();
+  assert(stats.highWaterMarks == 2);
+  assert(stats.messagesSent == 2);
+  (void)stats;
+  destroy(conn, peer);
+}
+
+/// One writev takes the pending bytes of output buffer and part of iov,
+/// only the unsent tail of iov is copied.
+void testPartialWritev() {
+  EventLoop loop;
+  int peer = -1;
+  size_t capacity = 0;
+  TcpConnectionPtr conn = newConnection(&loop, &peer, &capacity);
+  const size_t kPending = 16 * 1024;
+  assert(capacity > 2 * kPending);
+  const std::string first(capacity + kPending, 'a');
+  conn->send(first);
+  const size_t pending = conn->outputBuffer()->readableBytes();
+  assert(pending > 0 && pending < capacity);
+  /// room for all pending bytes and some of iov
+  std::string received = readFully(peer, first.size() - pending);
+
+  Segments segments(3, capacity);
+  conn->send(segments.iov.data(), segments.count());
+  const size_t tail = conn->outputBuffer()->readableBytes();
+  assert(tail > 0 && tail < segments.joined.size());
+  (void)tail;
+  received += receive(&loop, peer, pending + segments.joined.size());
+  assert(received == first + segments.joined);
+  assert(conn->stats().messagesSent == 2);
+  destroy(conn, peer);
+}
+
+/// neither drops pending output nor stops writing it
+void testEmptyIovWhilePending() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  const std::string first(kLargeMessage, 'a');
+  conn->send(first);
+  const size_t pending = conn->outputBuffer()->readableBytes();
+  assert(pending > 0);
+  struct iovec empty[2];
+  empty[0].iov_base = const_cast<char*>(first.data());
+  empty[0].iov_len = 0;
+  empty[1] = empty[0];
+  conn->send(empty, 2);
+  assert(conn->outputBuffer()->readableBytes() <= pending);
+  (void)pending;
+  assert(receive(&loop, peer, first.size()) == first);
+  destroy(conn, peer);
+}
+
+/// segments beyond what one writev takes are copied, in order
+void testManySegments() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  /// TcpConnection writes at most 64 segments at once
+  const int kSegments = 100;
+  const size_t kSegmentSize = 1000;
+  Segments segments(kSegments, kSegmentSize);
+  conn->send(segments.iov.data(), segments.count());
+  assert(conn->outputBuffer()->readableBytes() >= (kSegments - 64) * kSegmentSize);
+  assert(receive(&loop, peer, segments.joined.size()) == segments.joined);
+  destroy(conn, peer);
+}
+
+/// from another thread segments are copied before send() returns
+void testSendFromOtherThread() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  Segments segments(3, 1000);
+  const std::string expected = segments.joined;
+  Thread sender(
+      [&](void*) {
+        conn->send(segments.iov.data(), segments.count());
+        for (std::string& d : segments.data) d.assign(d.size(), '#');
+      },
+      nullptr, "sender");
+  sender.start();
+  sender.join();
+  assert(conn->outputBuffer()->readableBytes() == 0);
+  assert(receive(&loop, peer, expected.size()) == expected);
+  destroy(conn, peer);
+}
+
+/// a send after sendFile() waits for the file
+void testSendBehindFile() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  const std::string head = "head";
+  const std::string content(kLargeMessage, 'f');
+  int fd = tempFile(content);
+  conn->send(head);
+  conn->sendFile(fd, 0, content.size());
+  ::close(fd);
+  Segments segments(3, 1000);
+  conn->send(segments.iov.data(), segments.count());
+  const std::string expected = head + content + segments.joined;
+  assert(receive(&loop, peer, expected.size()) == expected);
+  assert(conn->stats().messagesSent == 3);
+  destroy(conn, peer);
+}
+
+/// Bytes buffered ahead of the file, the file and a trailer arrive in
+/// order, with the caller's fd closed right after sendFile(). The file
+/// crosses the high water mark once, write complete comes after it.
+void testSendFile() {
+  EventLoop loop;
+  int peer = -1;
+  size_t capacity = 0;
+  TcpConnectionPtr conn = newConnection(&loop, &peer, &capacity);
+  int highWaterMarks = 0;
+  conn->setHighWaterMarkCallback(
+      [&highWaterMarks](const TcpConnectionPtr&, uint32_t) {
+        ++highWaterMarks;
+      },
+      kHighWaterMark);
+  int writeCompletes = 0;
+  size_t pendingAtWriteComplete = 1;
+  conn->setWriteCompleteCallback([&](const TcpConnectionPtr& c) {
+    ++writeCompletes;
+    pendingAtWriteComplete = c->pendingOutputBytes();
+  });
+  /// buffered, below the high water mark
+  const std::string head(capacity + kHighWaterMark / 4, 'h');
+  conn->send(head);
+  assert(conn->outputBuffer()->readableBytes() > 0);
+  const std::string content(kLargeMessage, 'f');
+  int fd = tempFile(content);
+  conn->sendFile(fd, 0, content.size());
+  ::close(fd);
+  const std::string trailer = "trailer";
+  conn->send(trailer);
+  assert(conn->pendingOutputBytes() >= content.size() + trailer.size());
+  assert(highWaterMarks == 0);
+
+  const std::string expected = head + content + trailer;
+  assert(receive(&loop, peer, expected.size()) == expected);
+  assert(highWaterMarks == 1);
+  assert(conn->stats().highWaterMarks == 1);
+  assert(writeCompletes == 1);
+  assert(pendingAtWriteComplete == 0);
+  (void)pendingAtWriteComplete;
+  destroy(conn, peer);
+}
+
+/// the stream is broken when the file ends early, connection is closed
+void testShortFile() {
+  EventLoop loop;
+  int peer = -1;
+  TcpConnectionPtr conn = newConnection(&loop, &peer);
+  conn->setConnectionCallback([&loop](const TcpConnectionPtr& c) {
+    if (c->disconnected()) loop.quit();
+  });
+  /// buffered, the file is sent from the loop
+  const std::string head(kLargeMessage, 'h');
+  conn->send(head);
+  const std::string content(1000, 'f');
+  int fd = tempFile(content);
+  conn->sendFile(fd, 0, content.size() + 1000);
+  ::close(fd);
+  const std::string sent = head + content;
+  assert(receive(&loop, peer, sent.size(), false) == sent);
+  assert(conn->disconnected());
+  destroy(conn, peer);
+}
+
+int main() {
+  testSendInBracket();
+  testPartialWritev();
+  testEmptyIovWhilePending();
+  testManySegments();
+  testSendFromOtherThread();
+  testSendBehindFile();
+  testSendFile();
+  testShortFile();
+  printf("tcp_connection_send_test passed\n");
+  return 0;
+}
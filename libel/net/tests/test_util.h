@@ -0,0 +1,30 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_TEST_UTIL_H
+#define LIBEL_TEST_UTIL_H
+
+#include "libel/net/inet_address.h"
+
+#include <cassert>
+#include <sys/socket.h>
+
+namespace Libel {
+
+namespace net {
+
+/// blocking client socket connected to addr, for tests
+inline int connectTo(const InetAddress& addr) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  assert(fd >= 0);
+  int ret = ::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in));
+  assert(ret == 0);
+  (void)ret;
+  return fd;
+}
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_TEST_UTIL_H
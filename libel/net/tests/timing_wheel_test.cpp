@@ -0,0 +1,72 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/eventloop.h"
+#include "libel/net/timerId.h"
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+using namespace Libel;
+using namespace Libel::net;
+
+EventLoop* g_loop = nullptr;
+int g_fired = 0;
+int g_canceledFired = 0;
+int g_every = 0;
+TimerId g_everyId;
+
+void onTimer(TimeStamp when) {
+  /// never runs earlier than asked
+  assert(!(TimeStamp::now() < when));
+  ++g_fired;
+}
+
+void onCanceled() { ++g_canceledFired; }
+
+void onEvery() {
+  if (++g_every == 3) {
+    /// canceling a repeated timer inside its own callback
+    g_loop->cancel(g_everyId);
+  }
+}
+
+void check(int expected) {
+  printf("fired %d of %d, every %d\n", g_fired, expected, g_every);
+  assert(g_fired == expected);
+  assert(g_canceledFired == 0);
+  assert(g_every == 3);
+  g_loop->quit();
+}
+
+int main() {
+  EventLoop loop;
+  g_loop = &loop;
+  /// 10us ticks, so that 1.2 seconds spans three levels
+  loop.useTimingWheel(0.00001);
+
+  std::vector<TimerId> toCancel;
+  int expected = 0;
+  for (int i = 0; i < 2000; ++i) {
+    double delay = 0.0005 * (i % 400) + 0.0000037 * i;
+    TimeStamp when = addTime(TimeStamp::now(), delay);
+    loop.runAt(when, std::bind(onTimer, when));
+    ++expected;
+    toCancel.push_back(loop.runAfter(delay, onCanceled));
+  }
+  /// already expired timers run on next alarm
+  loop.runAt(TimeStamp(1), std::bind(onTimer, TimeStamp(1)));
+  ++expected;
+  TimeStamp far = addTime(TimeStamp::now(), 1.2);
+  loop.runAt(far, std::bind(onTimer, far));
+  ++expected;
+  for (const auto& timerId : toCancel) {
+    loop.cancel(timerId);
+  }
+  g_everyId = loop.runEvery(0.05, onEvery);
+  loop.runAfter(1.5, std::bind(check, expected));
+  loop.loop();
+  return 0;
+}
@@ -6,6 +6,7 @@
 #define LIBEL_TIMER_H
 
 #include <atomic>
+#include <memory>
 
 #include "libel/base/noncopyable.h"
 #include "libel/base/timestamp.h"
@@ -15,6 +16,8 @@ namespace Libel {
 
 namespace net {
 
+class TimingWheel;
+
 ///
 /// Internal class for timer event.
 ///
@@ -25,7 +28,12 @@ class Timer : noncopyable {
         expiration_(when),
         interval_(interval),
         repeat_(interval_ > 0.0),
-        sequence_(s_numCreated_++) {}
+        sequence_(s_numCreated_++),
+        wheelPrev_(nullptr),
+        wheelNext_(nullptr),
+        wheelTick_(0),
+        wheelLevel_(0),
+        wheelSlot_(0) {}
 
   void run() const { callback_(); }
 
@@ -47,6 +55,16 @@ class Timer : noncopyable {
   const int64_t sequence_;
 
   static std::atomic<int64_t> s_numCreated_;
+
+  /// intrusive links of TimingWheel, so that cancel is O(1)
+  friend class TimingWheel;
+  Timer* wheelPrev_;
+  Timer* wheelNext_;
+  int64_t wheelTick_;
+  int wheelLevel_;
+  int wheelSlot_;
+  /// keeps the timer alive while it is linked in a wheel slot
+  std::shared_ptr<Timer> wheelSelf_;
 };
 
 }  // namespace net
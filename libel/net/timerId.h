@@ -22,7 +22,7 @@ public:
 
   TimerId(std::shared_ptr<Timer> timer, int64_t seq) : timer_(std::move(timer)), sequence_(seq) {}
 
-  friend class TimerQueue;
+  friend class TimerScheduler;
 
 private:
   std::shared_ptr<Timer> timer_;
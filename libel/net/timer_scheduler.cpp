@@ -0,0 +1,154 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/timer_scheduler.h"
+
+#include "libel/base/logging.h"
+#include "libel/net/eventloop.h"
+#include "libel/net/timer.h"
+#include "libel/net/timerId.h"
+#include "libel/net/timerqueue.h"
+#include "libel/net/timing_wheel.h"
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace Libel {
+
+namespace net {
+
+namespace detail {
+
+int createTimerfd() {
+  int timerfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (timerfd < 0) {
+    LOG_FATAL << "failed to call timerfd_create";
+  }
+  return timerfd;
+}
+
+struct timespec howMuchTimeFromNow(TimeStamp when) {
+  int64_t ms =
+      when.microSecondsSinceEpoch() - TimeStamp::now().microSecondsSinceEpoch();
+  if (ms < 100) ms = 100;
+  struct timespec ts {};
+  ts.tv_sec = static_cast<time_t>(ms / TimeStamp::kMicroSecondsPerSecond);
+  ts.tv_nsec =
+      static_cast<long>((ms % TimeStamp::kMicroSecondsPerSecond) * 1000);
+  return ts;
+}
+
+void readTimerfd(int timerfd, TimeStamp now) {
+  uint64_t num;
+  ssize_t n = ::read(timerfd, &num, sizeof(num));
+  LOG_TRACE << "TimerScheduler::handleRead() " << num << " at " << now.toString();
+  if (n != sizeof(num)) {
+    LOG_ERROR << "TimerScheduler::handleRead() reads " << n
+              << " bytes instead of 8";
+  }
+}
+
+void resetTimerfd(int timerfd, TimeStamp expiration) {
+  /// wake up loop by timerfd_settime()
+  struct itimerspec newValue {};
+  struct itimerspec oldValue {};
+  memZero(&newValue, sizeof(newValue));
+  memZero(&oldValue, sizeof(oldValue));
+  newValue.it_value = howMuchTimeFromNow(expiration);
+  int ret = ::timerfd_settime(timerfd, 0, &newValue, &oldValue);
+  if (ret) {
+    LOG_ERROR << "failed to call timerfd_settime error:" << strerror(errno);
+  }
+}
+
+}  // namespace detail
+}  // namespace net
+}  // namespace Libel
+
+using namespace Libel;
+using namespace Libel::net;
+using namespace Libel::net::detail;
+
+TimerScheduler* TimerScheduler::newDefaultTimerScheduler(EventLoop* loop) {
+  if (::getenv("LIBEL_USE_TIMING_WHEEL"))
+    return new TimingWheel(loop);
+  else
+    return new TimerQueue(loop);
+}
+
+TimerScheduler::TimerScheduler(EventLoop* loop)
+    : loop_(loop),
+      timerfd_(createTimerfd()),
+      timerfdChannel_(loop, timerfd_),
+      callingExpiredTimers_(false) {
+  timerfdChannel_.setReadCallback(std::bind(&TimerScheduler::handleRead, this));
+  timerfdChannel_.enableReading();
+}
+
+TimerScheduler::~TimerScheduler() {
+  timerfdChannel_.disableAll();
+  timerfdChannel_.removeSelfFromLoop();
+  ::close(timerfd_);
+}
+
+TimerId TimerScheduler::addTimer(TimerCallback cb, TimeStamp when,
+                                 double interval) {
+  /// one allocation for both Timer and its control block
+  std::shared_ptr<Timer> timer =
+      std::make_shared<Timer>(std::move(cb), when, interval);
+  loop_->runInLoop(std::bind(&TimerScheduler::addTimerInLoop, this, timer));
+  return TimerId{timer, timer->sequence()};
+}
+
+void TimerScheduler::cancel(const TimerId& timerId) {
+  loop_->runInLoop(std::bind(&TimerScheduler::cancelInLoop, this, timerId));
+}
+
+void TimerScheduler::addTimerInLoop(const TimerPtr& timer) {
+  loop_->assertInLoopThread();
+  if (insert(timer)) {
+    resetTimerfd(timerfd_, nextExpiration());
+  }
+}
+
+void TimerScheduler::cancelInLoop(const TimerId& timerId) {
+  loop_->assertInLoopThread();
+  if (!timerId.timer_) return;
+  if (!remove(timerId.timer_, timerId.sequence_) && callingExpiredTimers_) {
+    cancelingTimers_.insert(
+        ActiveTimer(get_pointer(timerId.timer_), timerId.sequence_));
+  }
+}
+
+void TimerScheduler::handleRead() {
+  loop_->assertInLoopThread();
+  TimeStamp now(TimeStamp::now());
+  readTimerfd(timerfd_, now);
+  expired_.clear();
+  getExpired(now, &expired_);
+  callingExpiredTimers_ = true;
+  cancelingTimers_.clear();
+
+  for (const auto& timer : expired_)
+    timer->run();
+  callingExpiredTimers_ = false;
+  reset(expired_, now);
+  /// releases one-shot timers now, not on next alarm
+  expired_.clear();
+}
+
+void TimerScheduler::reset(const TimerPtrList& expired, TimeStamp now) {
+  for (const auto& timer : expired) {
+    ActiveTimer active(get_pointer(timer), timer->sequence());
+    if (timer->repeat() &&
+        cancelingTimers_.find(active) == cancelingTimers_.end()) {
+      timer->restart(now);
+      insert(timer);
+    }
+  }
+  TimeStamp nextExpire = nextExpiration();
+  if (nextExpire.valid()) {
+    resetTimerfd(timerfd_, nextExpire);
+  }
+}
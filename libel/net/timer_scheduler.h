@@ -0,0 +1,87 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_TIMER_SCHEDULER_H
+#define LIBEL_TIMER_SCHEDULER_H
+
+#include "libel/base/timestamp.h"
+#include "libel/net/callbacks.h"
+#include "libel/net/channel.h"
+
+#include <atomic>
+#include <set>
+#include <vector>
+
+namespace Libel {
+
+namespace net {
+
+class EventLoop;
+class Timer;
+class TimerId;
+
+///
+/// Base class of timer backends, one per EventLoop.
+///
+/// It owns the timerfd and does the cross-thread part of addTimer() and
+/// cancel(), subclasses only decide how pending timers are stored.
+/// No guarantee that the callback will be right on time
+///
+class TimerScheduler : noncopyable {
+ public:
+  explicit TimerScheduler(EventLoop* loop);
+  virtual ~TimerScheduler();
+
+  ///
+  /// Schedules the callback to be run at given time,
+  /// repeats if interval > 0.0.
+  ///
+  /// Must be thread safe. Usually be called from other threads.
+  TimerId addTimer(TimerCallback cb, TimeStamp when, double interval);
+
+  void cancel(const TimerId& timerId);
+
+  /// number of pending timers, in loop thread
+  virtual size_t size() const = 0;
+
+  /// LIBEL_USE_TIMING_WHEEL selects TimingWheel, TimerQueue otherwise
+  static TimerScheduler* newDefaultTimerScheduler(EventLoop* loop);
+
+ protected:
+  using TimerPtr = std::shared_ptr<Timer>;
+  using TimerPtrList = std::vector<TimerPtr>;
+
+  /// returns true if the timerfd needs to be armed earlier
+  virtual bool insert(const TimerPtr& timer) = 0;
+  /// returns false if timer is not pending, e.g. it is running
+  virtual bool remove(const TimerPtr& timer, int64_t sequence) = 0;
+  /// moves out all timers expired at now
+  virtual void getExpired(TimeStamp now, TimerPtrList* expired) = 0;
+  /// when timerfd should alarm next time, invalid if no timer
+  virtual TimeStamp nextExpiration() const = 0;
+
+  EventLoop* ownerLoop() const { return loop_; }
+
+ private:
+  using ActiveTimer = std::pair<Timer*, int64_t>;
+
+  void addTimerInLoop(const TimerPtr& timer);
+  void cancelInLoop(const TimerId& timerId);
+  /// called when timerfd alarms
+  void handleRead();
+  void reset(const TimerPtrList& expired, TimeStamp now);
+
+  EventLoop* loop_;
+  const int timerfd_;
+  Channel timerfdChannel_;
+  std::atomic<bool> callingExpiredTimers_;
+  /// repeated timers canceled by expired callbacks
+  std::set<ActiveTimer> cancelingTimers_;
+  TimerPtrList expired_;
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_TIMER_SCHEDULER_H
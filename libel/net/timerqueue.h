@@ -5,10 +5,9 @@
 #ifndef LIBEL_TIMERQUEUE_H
 #define LIBEL_TIMERQUEUE_H
 
-#include "libel/base/Mutex.h"
 #include "libel/base/timestamp.h"
 #include "libel/net/callbacks.h"
-#include "libel/net/channel.h"
+#include "libel/net/timer_scheduler.h"
 
 #include <set>
 #include <vector>
@@ -17,26 +16,16 @@ namespace Libel {
 
 namespace net {
 
-class EventLoop;
-class Timer;
-class TimerId;
-
 ///
-/// No guarantee that the callback will be right on time
+/// Default timer backend, pending timers are sorted by expiration
+/// in a std::set, O(log n) to add or cancel a timer.
 ///
-class TimerQueue : noncopyable {
+class TimerQueue : public TimerScheduler {
 public:
   explicit TimerQueue(EventLoop* loop);
-  ~TimerQueue();
-
-  ///
-  /// Schedules the callback to be run at given time,
-  /// repeats if interval > 0.0.
-  ///
-  /// Must be thread safe. Usually be called from other threads.
-  TimerId addTimer(TimerCallback cb, TimeStamp when, double interval);
+  ~TimerQueue() override;
 
-  void cancel(const TimerId&);
+  size_t size() const override { return timers_.size(); }
 
 private:
   using Entry =std::pair<TimeStamp, std::shared_ptr<Timer>>;
@@ -51,26 +40,16 @@ public:
   ActiveTimerSet getActiveTimers() const { return activeTimers_; }
 
 private:
-  void addTimerInLoop(const std::shared_ptr<Timer> &timer);
-  void cancelInLoop(const TimerId &timerId);
-  /// called when timerfd alarms
-  void handleRead();
-  /// move out all expired timers
-  std::vector<Entry> getExpired(TimeStamp now);
-  void reset(const std::vector<Entry>& expired, TimeStamp now);
-
-  bool insert(const std::shared_ptr<Timer> &timer);
-
-  EventLoop* loop_;
-  const int timerfd_;
-  Channel timerfdChannel_;
+  bool insert(const TimerPtr& timer) override;
+  bool remove(const TimerPtr& timer, int64_t sequence) override;
+  void getExpired(TimeStamp now, TimerPtrList* expired) override;
+  TimeStamp nextExpiration() const override;
+
   /// Timer list sorted by expiration
   TimerList timers_;
 
   /// for cancel()
   ActiveTimerSet activeTimers_;
-  std::atomic<bool> callingExpiredTimers_;
-  ActiveTimerSet cancelingTimers_;
 };
 
 
@@ -0,0 +1,226 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#include "libel/net/timing_wheel.h"
+
+#include "libel/net/eventloop.h"
+#include "libel/net/timer.h"
+
+#include <algorithm>
+
+using namespace Libel;
+using namespace Libel::net;
+
+const int TimingWheel::kLevels;
+const int TimingWheel::kSlotBits;
+const int TimingWheel::kSlots;
+const int64_t TimingWheel::kNever;
+const int TimingWheel::kSlotMask;
+const int TimingWheel::kWordsPerLevel;
+
+TimingWheel::TimingWheel(EventLoop* loop, double tickSeconds)
+    : TimerScheduler(loop),
+      startTime_(TimeStamp::now().microSecondsSinceEpoch()),
+      tickMicroSeconds_(std::max<int64_t>(
+          1, static_cast<int64_t>(tickSeconds *
+                                  TimeStamp::kMicroSecondsPerSecond))),
+      currentTick_(0),
+      armedTick_(kNever),
+      size_(0) {
+  memZero(slots_, sizeof(slots_));
+  memZero(occupied_, sizeof(occupied_));
+}
+
+TimingWheel::~TimingWheel() {
+  for (int level = 0; level < kLevels; ++level) {
+    for (int slot = 0; slot < kSlots; ++slot) {
+      Timer* timer = slots_[level][slot];
+      while (timer) {
+        Timer* next = timer->wheelNext_;
+        /// may destroy the timer
+        timer->wheelSelf_.reset();
+        timer = next;
+      }
+    }
+  }
+}
+
+double TimingWheel::tickSeconds() const {
+  return static_cast<double>(tickMicroSeconds_) /
+         TimeStamp::kMicroSecondsPerSecond;
+}
+
+bool TimingWheel::insert(const TimerPtr& timer) {
+  ownerLoop()->assertInLoopThread();
+  Timer* t = get_pointer(timer);
+  assert(!t->wheelSelf_);
+  t->wheelSelf_ = timer;
+  t->wheelTick_ = tickOf(t->expiration());
+  place(t, currentTick_ + 1);
+  ++size_;
+  int64_t tick = std::max(t->wheelTick_, currentTick_ + 1);
+  if (tick < armedTick_) {
+    armedTick_ = tick;
+    return true;
+  }
+  return false;
+}
+
+bool TimingWheel::remove(const TimerPtr& timer, int64_t sequence) {
+  ownerLoop()->assertInLoopThread();
+  Timer* t = get_pointer(timer);
+  if (!t->wheelSelf_ || t->sequence() != sequence) {
+    return false;
+  }
+  unlink(t);
+  --size_;
+  /// timer is still held by the caller
+  t->wheelSelf_.reset();
+  return true;
+}
+
+void TimingWheel::getExpired(TimeStamp now, TimerPtrList* expired) {
+  const int64_t elapsed = now.microSecondsSinceEpoch() - startTime_;
+  const int64_t nowTick = elapsed > 0 ? elapsed / tickMicroSeconds_ : 0;
+  while (currentTick_ < nowTick) {
+    /// skips ticks with nothing to do, instead of turning tick by tick
+    const int64_t tick = size_ > 0 ? nextTick() : kNever;
+    if (tick > nowTick) {
+      currentTick_ = nowTick;
+      break;
+    }
+    currentTick_ = tick;
+    /// higher levels first, they may cascade into the slot below
+    for (int level = kLevels - 1; level > 0; --level) {
+      const int shift = kSlotBits * level;
+      if ((tick & ((int64_t(1) << shift) - 1)) == 0) {
+        cascade(level, static_cast<int>((tick >> shift) & kSlotMask));
+      }
+    }
+    Timer* timer = slots_[0][tick & kSlotMask];
+    while (timer) {
+      Timer* next = timer->wheelNext_;
+      unlink(timer);
+      if (timer->wheelTick_ > currentTick_) {
+        /// was out of range of the top level
+        place(timer, currentTick_ + 1);
+      } else {
+        --size_;
+        expired->push_back(std::move(timer->wheelSelf_));
+      }
+      timer = next;
+    }
+  }
+  armedTick_ = size_ > 0 ? nextTick() : kNever;
+}
+
+TimeStamp TimingWheel::nextExpiration() const {
+  if (armedTick_ == kNever) {
+    return TimeStamp::invalid();
+  }
+  return timeOfTick(armedTick_);
+}
+
+int64_t TimingWheel::tickOf(TimeStamp when) const {
+  const int64_t elapsed = when.microSecondsSinceEpoch() - startTime_;
+  if (elapsed <= 0) return 0;
+  return (elapsed + tickMicroSeconds_ - 1) / tickMicroSeconds_;
+}
+
+TimeStamp TimingWheel::timeOfTick(int64_t tick) const {
+  return TimeStamp(startTime_ + tick * tickMicroSeconds_);
+}
+
+void TimingWheel::place(Timer* timer, int64_t minTick) {
+  int64_t tick = std::max(timer->wheelTick_, minTick);
+  const int64_t diff = tick - currentTick_;
+  assert(diff >= 0);
+  int level = 0;
+  while (level < kLevels - 1 &&
+         diff >= (int64_t(1) << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+  const int64_t maxDiff = (int64_t(1) << (kSlotBits * kLevels)) - 1;
+  if (diff > maxDiff) {
+    /// parks in the farthest slot, placed again when it comes down
+    tick = currentTick_ + maxDiff;
+  }
+  link(timer, level,
+       static_cast<int>((tick >> (kSlotBits * level)) & kSlotMask));
+}
+
+void TimingWheel::link(Timer* timer, int level, int slot) {
+  Timer*& head = slots_[level][slot];
+  timer->wheelLevel_ = level;
+  timer->wheelSlot_ = slot;
+  timer->wheelPrev_ = nullptr;
+  timer->wheelNext_ = head;
+  if (head) {
+    head->wheelPrev_ = timer;
+  }
+  head = timer;
+  occupied_[level][slot >> 6] |= uint64_t(1) << (slot & 63);
+}
+
+void TimingWheel::unlink(Timer* timer) {
+  const int level = timer->wheelLevel_;
+  const int slot = timer->wheelSlot_;
+  if (timer->wheelPrev_) {
+    timer->wheelPrev_->wheelNext_ = timer->wheelNext_;
+  } else {
+    assert(slots_[level][slot] == timer);
+    slots_[level][slot] = timer->wheelNext_;
+  }
+  if (timer->wheelNext_) {
+    timer->wheelNext_->wheelPrev_ = timer->wheelPrev_;
+  }
+  timer->wheelPrev_ = nullptr;
+  timer->wheelNext_ = nullptr;
+  if (!slots_[level][slot]) {
+    occupied_[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+  }
+}
+
+void TimingWheel::cascade(int level, int slot) {
+  Timer* timer = slots_[level][slot];
+  slots_[level][slot] = nullptr;
+  occupied_[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+  while (timer) {
+    Timer* next = timer->wheelNext_;
+    place(timer, currentTick_);
+    timer = next;
+  }
+}
+
+int64_t TimingWheel::nextTick() const {
+  int64_t result = kNever;
+  int distance = findOccupied(0, static_cast<int>((currentTick_ + 1) & kSlotMask));
+  if (distance >= 0) {
+    result = currentTick_ + 1 + distance;
+  }
+  for (int level = 1; level < kLevels; ++level) {
+    const int shift = kSlotBits * level;
+    const int64_t block = (currentTick_ >> shift) + 1;
+    distance = findOccupied(level, static_cast<int>(block & kSlotMask));
+    if (distance >= 0) {
+      result = std::min(result, (block + distance) << shift);
+    }
+  }
+  return result;
+}
+
+int TimingWheel::findOccupied(int level, int from) const {
+  int distance = 0;
+  while (distance < kSlots) {
+    const int index = (from + distance) & kSlotMask;
+    const int bit = index & 63;
+    const uint64_t bits = occupied_[level][index >> 6] >> bit;
+    if (bits) {
+      distance += __builtin_ctzll(bits);
+      return distance < kSlots ? distance : -1;
+    }
+    distance += 64 - bit;
+  }
+  return -1;
+}
@@ -0,0 +1,88 @@
+//
+// Created by kaymind on 2026/10/18.
+//
+
+#ifndef LIBEL_TIMING_WHEEL_H
+#define LIBEL_TIMING_WHEEL_H
+
+#include "libel/net/timer_scheduler.h"
+
+#include <cstdint>
+
+namespace Libel {
+
+namespace net {
+
+///
+/// Hierarchical timing wheel backend, for loops with lots of timers,
+/// e.g. one idle timeout per connection.
+///
+/// Time is cut into ticks of tickSeconds, kLevels wheels of kSlots slots
+/// each cover 2^(kSlotBits * (level + 1)) ticks. A timer is linked into
+/// the lowest level which covers its distance, and cascades down one
+/// level each time the wheel below it wraps around.
+/// Adding and canceling a timer is O(1), timers in one tick run in no
+/// particular order, and a timer runs at most one tick late.
+///
+/// @code
+///   level 3 [  ][  ][..][  ]  tick >> 24
+///   level 2 [  ][  ][..][  ]  tick >> 16
+///   level 1 [  ][  ][..][  ]  tick >> 8
+///   level 0 [  ][  ][..][  ]  tick
+/// @endcode
+///
+class TimingWheel : public TimerScheduler {
+ public:
+  static const int kLevels = 4;
+  static const int kSlotBits = 8;
+  static const int kSlots = 1 << kSlotBits;
+
+  /// tickSeconds is the resolution, 1ms by default
+  explicit TimingWheel(EventLoop* loop, double tickSeconds = 0.001);
+  ~TimingWheel() override;
+
+  size_t size() const override { return size_; }
+
+  double tickSeconds() const;
+
+ private:
+  static const int64_t kNever = INT64_MAX;
+  static const int kSlotMask = kSlots - 1;
+  static const int kWordsPerLevel = kSlots / 64;
+
+  bool insert(const TimerPtr& timer) override;
+  bool remove(const TimerPtr& timer, int64_t sequence) override;
+  void getExpired(TimeStamp now, TimerPtrList* expired) override;
+  TimeStamp nextExpiration() const override;
+
+  /// first tick not before when
+  int64_t tickOf(TimeStamp when) const;
+  TimeStamp timeOfTick(int64_t tick) const;
+
+  /// links timer into the slot of its wheelTick_, not earlier than minTick
+  void place(Timer* timer, int64_t minTick);
+  void link(Timer* timer, int level, int slot);
+  void unlink(Timer* timer);
+  /// moves timers of one slot down to lower levels
+  void cascade(int level, int slot);
+  /// the earliest tick after currentTick_ at which a slot needs work,
+  /// kNever if empty
+  int64_t nextTick() const;
+  /// distance from 'from' to the first occupied slot, circularly, -1 if none
+  int findOccupied(int level, int from) const;
+
+  const int64_t startTime_;  // microseconds
+  const int64_t tickMicroSeconds_;
+  /// all timers up to currentTick_ have been expired
+  int64_t currentTick_;
+  /// tick that timerfd is armed for
+  int64_t armedTick_;
+  size_t size_;
+  Timer* slots_[kLevels][kSlots];
+  uint64_t occupied_[kLevels][kWordsPerLevel];
+};
+
+}  // namespace net
+}  // namespace Libel
+
+#endif  // LIBEL_TIMING_WHEEL_H